@@ -315,6 +315,10 @@ void playAnimationForCue(int cueIndex)
         break;
     }
     
+    // Join the cue where the clock is, e.g. after a power cut mid-cue.
+    // seek() takes animation time, which runs at animationSpeed
+    notifier.seek(currentSecond * 1000UL * animationSpeed);
+    
     Serial.println("---------------------");
     
     // Update display when animation changes
@@ -0,0 +1,141 @@
+/*
+ * RTC Servo Animation - Wall Clock Cues
+ * 
+ * This sketch plays a servo animation at each minute cue, like the
+ * Simple Time Cues example, but schedules it by the RTC's time instead
+ * of starting it whenever loop() notices the new minute. Every board
+ * running this sketch with its RTC set to the same time moves its servo
+ * in step with the others, with no wires or network between them.
+ * 
+ * Key Functions:
+ * - setup(): Initializes the RTC, servo and wall clock, and creates the animations
+ * - loop(): Keeps the wall clock in line with the RTC and schedules each cue
+ * - rtcSeconds(): Reads the RTC as seconds since 1970 for the WallClock
+ * - setupAnimations(): Creates the animations for the servo
+ * 
+ * Key Variables:
+ * - wallClock: Turns the RTC's whole seconds into ms-accurate time
+ * - notifier: ServoNotifier that plays the animations
+ * - lastCueMinute: Minute (since 1970) of the last cue that was scheduled
+ * - lastSyncMinute: Minute of the last drift correction
+ * 
+ * Implementation Notes:
+ * - playAt() takes the cue's start time, so a late loop() still joins
+ *   the animation exactly where it should be
+ * - syncToWallClock() once a minute removes the drift between the
+ *   board's own clock and the RTC
+ * - wallClock.update() must run every loop()
+ */
+
+// Include the required libraries
+#include "RTC.h"
+#include <Servo.h>
+#include "YouveBeenNotified.h"
+
+// Create servo object and specify the pin
+Servo myServo;
+int servoPin = 9;  // Connect servo to pin 9
+
+// Create ServoNotifier object
+ServoNotifier notifier(myServo);
+
+// Reads the RTC as seconds since 1970
+unsigned long rtcSeconds() {
+  RTCTime now;
+  RTC.getTime(now);
+  return now.getUnixTime();
+}
+
+// Wall clock driven by the RTC
+WallClock wallClock(rtcSeconds);
+
+// Animation names and the mode each one plays in
+String animNames[] = {"Wave", "Sweep", "Pulse"};
+PlayMode animModes[] = {LOOP, BOOMERANG, ONCE};
+
+// Minutes (since 1970) of the last scheduled cue and the last drift correction
+unsigned long lastCueMinute = 0;
+unsigned long lastSyncMinute = 0;
+
+void setup() {
+  // Initialize Serial Communication
+  Serial.begin(9600);
+  
+  // Initialize the RTC
+  RTC.begin();
+
+  // Set initial time. Set the same time on every board to keep them in step
+  RTCTime initialTime(04, Month::APRIL, 2025, 10, 0, 0, DayOfWeek::FRIDAY, SaveLight::SAVING_TIME_ACTIVE);
+  RTC.setTime(initialTime);
+
+  // Attach servo to the pin
+  myServo.attach(servoPin);
+  
+  // Wait for the RTC's next second so the wall clock knows its ms
+  if (wallClock.sync()) {
+    Serial.println("Wall clock synced to the RTC");
+  }
+  
+  // Setup animations
+  setupAnimations();
+}
+
+void loop() {
+  // Keep the wall clock in line with the RTC
+  wallClock.update();
+  
+  // Cue a new animation at the start of each minute
+  unsigned long now = rtcSeconds();
+  unsigned long minute = now / 60;
+  if (minute != lastCueMinute) {
+    lastCueMinute = minute;
+    int cue = minute % 3;
+    
+    // Scheduled for the exact start of the minute, however late we are
+    notifier.playAt(animNames[cue], wallClock, minute * 60, animModes[cue]);
+    Serial.print("Playing ");
+    Serial.println(animNames[cue]);
+  }
+  else if (now % 60 >= 30 && minute != lastSyncMinute) {
+    // Half way through the minute: correct any drift
+    lastSyncMinute = minute;
+    notifier.syncToWallClock();
+  }
+  
+  // Update the animation
+  notifier.update();
+  
+  // Check if the animation value has changed
+  if (notifier.hasChanged()) {
+    // Move the servo to the current position
+    myServo.write(notifier.getValue());
+  }
+}
+
+// Creates and sets up the animations
+void setupAnimations() {
+  // Animation 0 - "Wave" (slow back and forth) - LOOP mode
+  KeyframeAnimation anim0(animNames[0]);
+  anim0.addKeyFrame(0, 0);      // Start at 0 degrees
+  anim0.addKeyFrame(90, 1000);  // Move to 90 degrees over 1 second
+  anim0.addKeyFrame(30, 2000);  // Move to 30 degrees over 1 second
+  anim0.addKeyFrame(0, 3000);   // Back to the start after 3 seconds total
+  
+  // Animation 1 - "Sweep" (full range sweep) - BOOMERANG mode
+  KeyframeAnimation anim1(animNames[1]);
+  anim1.addKeyFrame(0, 0);       // Start at 0 degrees
+  anim1.addKeyFrame(180, 1500);  // Sweep all the way to 180 over 1.5 seconds
+  
+  // Animation 2 - "Pulse" (quick pulses) - ONCE mode
+  KeyframeAnimation anim2(animNames[2]);
+  anim2.addKeyFrame(90, 0);      // Start at center (90 degrees)
+  anim2.addKeyFrame(45, 300);    // Quick pulse to 45
+  anim2.addKeyFrame(90, 600);    // Back to center
+  anim2.addKeyFrame(135, 900);   // Quick pulse to 135
+  anim2.addKeyFrame(90, 1200);   // End at center
+  
+  // Add all animations to the notifier
+  notifier.addAnimation(anim0);
+  notifier.addAnimation(anim1);
+  notifier.addAnimation(anim2);
+}
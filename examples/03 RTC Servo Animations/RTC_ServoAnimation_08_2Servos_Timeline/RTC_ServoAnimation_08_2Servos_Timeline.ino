@@ -0,0 +1,144 @@
+/*
+ * RTC Servo Animation - Timeline
+ * 
+ * This sketch plays a five minute show on two servos from a cue sheet.
+ * Instead of an if statement per cue, every cue is added to a Timeline
+ * once in setup(): when it fires, which servo, which animation, its
+ * playback mode and an optional crossfade time. The RTC starts the
+ * show again every five minutes.
+ * 
+ * Key Functions:
+ * - setup(): Initializes the RTC and servos, creates the animations and the cue sheet
+ * - loop(): Starts the show every five minutes and updates the group
+ * - setupAnimations(): Creates the animations for the servos
+ * - setupCues(): Adds the cues to the timeline
+ * 
+ * Key Variables:
+ * - group: NotifierGroup that updates both servos and fires the timeline's cues
+ * - timeline: The cue sheet, with cue times in ms from the start of the show
+ * - lastShowMinute: Minute of the hour the show was last started
+ * 
+ * Implementation Notes:
+ * - The group fires due cues at the start of every update(), so no cue is
+ *   missed, and a cue fired late plays as if it had fired on time
+ * - Cues with a crossfade time blend from whatever the servo was playing
+ * - No delay() calls are used; the group handles all timing
+ */
+
+// Include the required libraries
+#include "RTC.h"
+#include <Servo.h>
+#include "YouveBeenNotified.h"
+
+// Create servo objects and specify the pins
+Servo servoA;
+Servo servoB;
+int servoPinA = 9;   // Connect the first servo to pin 9
+int servoPinB = 10;  // Connect the second servo to pin 10
+
+// Create ServoNotifier objects and the group that updates them
+ServoNotifier notifierA(servoA);
+ServoNotifier notifierB(servoB);
+NotifierGroup group;
+
+// The cue sheet
+Timeline timeline;
+
+// Minute of the hour the show was last started
+int lastShowMinute = -1;
+
+void setup() {
+  // Initialize Serial Communication
+  Serial.begin(9600);
+  
+  // Initialize the RTC
+  RTC.begin();
+
+  // Set initial time
+  RTCTime initialTime(04, Month::APRIL, 2025, 10, 0, 0, DayOfWeek::FRIDAY, SaveLight::SAVING_TIME_ACTIVE);
+  RTC.setTime(initialTime);
+
+  // Attach servos to the pins
+  servoA.attach(servoPinA);
+  servoB.attach(servoPinB);
+  
+  // Setup animations and cues
+  setupAnimations();
+  setupCues();
+  
+  // The group fires the timeline's cues when it updates
+  group.add(notifierA);
+  group.add(notifierB);
+  group.setTimeline(&timeline);
+  
+  Serial.print("Cues in the show: ");
+  Serial.println(timeline.getCueCount());
+}
+
+void loop() {
+  // Get current time
+  RTCTime currentTime;
+  RTC.getTime(currentTime);
+  int minute = currentTime.getMinutes();
+  
+  // Start the show every five minutes
+  if (minute % 5 == 0 && minute != lastShowMinute) {
+    lastShowMinute = minute;
+    timeline.start();
+    Serial.println("Show started");
+  }
+  
+  // Fire any cues that are due and update both servos
+  group.update();
+  
+  // Move each servo when its value changes
+  if (notifierA.hasChanged()) {
+    servoA.write(notifierA.getValue());
+  }
+  if (notifierB.hasChanged()) {
+    servoB.write(notifierB.getValue());
+  }
+}
+
+// Creates and sets up the animations
+void setupAnimations() {
+  // "Wave" (slow back and forth)
+  KeyframeAnimation wave("Wave");
+  wave.addKeyFrame(0, 0);       // Start at 0 degrees
+  wave.addKeyFrame(90, 1000);   // Move to 90 degrees over 1 second
+  wave.addKeyFrame(30, 2000);   // Move to 30 degrees over 1 second
+  wave.addKeyFrame(0, 3000);    // Back to the start after 3 seconds total
+  
+  // "Sweep" (full range sweep)
+  KeyframeAnimation sweep("Sweep");
+  sweep.addKeyFrame(0, 0);       // Start at 0 degrees
+  sweep.addKeyFrame(180, 1500);  // Sweep all the way to 180 over 1.5 seconds
+  
+  // "Rest" (hold at center)
+  KeyframeAnimation rest("Rest");
+  rest.addKeyFrame(90, 0);       // Center
+  rest.addKeyFrame(90, 1000);    // Stay there
+  
+  // Both servos can play every animation
+  notifierA.addAnimation(wave);
+  notifierA.addAnimation(sweep);
+  notifierA.addAnimation(rest);
+  notifierB.addAnimation(wave);
+  notifierB.addAnimation(sweep);
+  notifierB.addAnimation(rest);
+}
+
+// Adds the cues: time (ms from the start), servo, animation, mode and crossfade time
+void setupCues() {
+  timeline.reserve(10);
+  timeline.addCue(0,      notifierA, "Rest",  ONCE);
+  timeline.addCue(0,      notifierB, "Rest",  ONCE);
+  timeline.addCue(5000,   notifierA, "Wave",  LOOP);
+  timeline.addCue(20000,  notifierB, "Sweep", BOOMERANG);
+  timeline.addCue(60000,  notifierA, "Sweep", BOOMERANG, 2000);  // Crossfade over 2 seconds
+  timeline.addCue(90000,  notifierB, "Wave",  LOOP, 2000);
+  timeline.addCue(150000, notifierA, "Wave",  LOOP, 1000);
+  timeline.addCue(180000, notifierB, "Sweep", BOOMERANG, 1000);
+  timeline.addCue(240000, notifierA, "Rest",  ONCE, 3000);       // Both settle at the end
+  timeline.addCue(240000, notifierB, "Rest",  ONCE, 3000);
+}
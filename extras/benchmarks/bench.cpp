@@ -0,0 +1,90 @@
+// bench.cpp
+// Benchmark registry and entry point
+//
+// Usage: ybn_bench [filter] [--min-ms N]
+// Only cases whose name contains the filter are run. Exits with status
+// 1 if any case reported a failure
+
+#include "bench.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace bench {
+
+namespace {
+    struct Case {
+        const char* name;
+        CaseFunction function;
+    };
+
+    std::vector<Case>& registry() {
+        static std::vector<Case> cases;
+        return cases;
+    }
+
+    bool failed = false;
+
+    volatile long longSink;
+    volatile float floatSink;
+}
+
+void keep(long value) {
+    longSink = value;
+}
+
+void keep(float value) {
+    floatSink = value;
+}
+
+Runner::Runner(const std::string& caseName, double minNanos)
+    : caseName(caseName), minNanos(minNanos) {
+}
+
+void Runner::report(const std::string& label, double value, const char* unit) {
+    std::printf("%-28s %-44s %14.2f %s\n", caseName.c_str(), label.c_str(), value, unit);
+    std::fflush(stdout);
+}
+
+void Runner::fail(const std::string& label, const char* reason) {
+    std::printf("%-28s %-44s FAILED: %s\n", caseName.c_str(), label.c_str(), reason);
+    std::fflush(stdout);
+    failed = true;
+}
+
+bool anyFailed() {
+    return failed;
+}
+
+Registrar::Registrar(const char* name, CaseFunction function) {
+    Case entry = {name, function};
+    registry().push_back(entry);
+}
+
+} // namespace bench
+
+int main(int argc, char** argv) {
+    const char* filter = "";
+    double minMs = 50.0;
+
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--min-ms") == 0 && i + 1 < argc) {
+            minMs = std::atof(argv[++i]);
+        } else {
+            filter = argv[i];
+        }
+    }
+
+    std::printf("%-28s %-44s %14s\n", "case", "parameters", "result");
+    for (size_t i = 0; i < bench::registry().size(); i++) {
+        const char* name = bench::registry()[i].name;
+        if (std::strstr(name, filter) == nullptr) {
+            continue;
+        }
+        bench::Runner runner(name, minMs * 1e6);
+        bench::registry()[i].function(runner);
+    }
+    return bench::anyFailed() ? 1 : 0;
+}
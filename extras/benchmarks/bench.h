@@ -0,0 +1,69 @@
+// bench.h
+// Tiny self-contained benchmark harness for the host build
+// Cases register themselves with YBN_BENCH and report ns per item
+
+#ifndef YBN_BENCH_H
+#define YBN_BENCH_H
+
+#include <chrono>
+#include <string>
+
+namespace bench {
+
+// Keeps the optimizer from discarding a computed value
+void keep(long value);
+void keep(float value);
+
+class Runner {
+private:
+    std::string caseName;
+    double minNanos;
+
+public:
+    Runner(const std::string& caseName, double minNanos);
+
+    // Calls body() until enough time has passed and reports the
+    // average cost of one item (body() handles itemsPerCall items)
+    template <typename Body>
+    void measure(const std::string& label, long itemsPerCall, Body body) {
+        typedef std::chrono::steady_clock Clock;
+        long calls = 1;
+        double elapsed = 0;
+        for (;;) {
+            Clock::time_point start = Clock::now();
+            for (long i = 0; i < calls; i++) {
+                body();
+            }
+            elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+            if (elapsed >= minNanos || calls >= (1L << 30)) {
+                break;
+            }
+            calls *= 2;
+        }
+        report(label, elapsed / (static_cast<double>(calls) * itemsPerCall), "ns/item");
+    }
+
+    // Reports a value that is not a timing (sizes, errors, counts)
+    void report(const std::string& label, double value, const char* unit);
+
+    // Marks the run as failed; ybn_bench then exits with status 1
+    void fail(const std::string& label, const char* reason);
+};
+
+typedef void (*CaseFunction)(Runner& runner);
+
+// True once any Runner::fail() has been called
+bool anyFailed();
+
+struct Registrar {
+    Registrar(const char* name, CaseFunction function);
+};
+
+} // namespace bench
+
+#define YBN_BENCH(name) \
+    static void name(bench::Runner& runner); \
+    static bench::Registrar name##Registrar(#name, name); \
+    static void name(bench::Runner& runner)
+
+#endif // YBN_BENCH_H
@@ -0,0 +1,93 @@
+// bench_alloc.cpp
+// Counts heap allocations made while animations play. Everything that
+// allocates belongs in setup(); the loop below must allocate nothing
+
+#include "bench.h"
+#include "fixtures.h"
+
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+namespace {
+
+bool counting = false;
+long allocations = 0;
+
+} // namespace
+
+// Replaces the global allocator for the whole benchmark program
+void* operator new(std::size_t size) {
+    if (counting) {
+        allocations++;
+    }
+    void* memory = std::malloc(size == 0 ? 1 : size);
+    if (memory == nullptr) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+YBN_BENCH(loopAllocations) {
+    // setup(): everything that may allocate
+    host::setMicros(0);
+    getAnimationLibrary().reserve(getAnimationLibrary().getCount() + 2);
+
+    std::vector<ServoNotifier> servos(4);
+    std::vector<LEDNotifier> leds(2, LEDNotifier(9, ANALOG));
+    NotifierGroup group;
+    AnimationId sweep = NO_ANIMATION;
+    AnimationId pulse = NO_ANIMATION;
+    for (auto& servo : servos) {
+        sweep = servo.addAnimation(fixtures::makeCurve("allocSweep", 64));
+        pulse = servo.addAnimation(fixtures::makeCurve("allocPulse", 8));
+        servo.playAnimation(sweep, PLAY_BOOMERANG);
+        group.add(servo);
+    }
+    for (auto& led : leds) {
+        led.addAnimation(fixtures::makeCurve("allocPulse", 8));
+        led.playAnimation(pulse, PLAY_LOOP);
+        group.add(led);
+    }
+    // One frame so the host pin table has every pin in it
+    group.update();
+
+    // loop(): ten simulated minutes of frames, switching and pausing
+    allocations = 0;
+    counting = true;
+    long checksum = 0;
+    for (int frame = 0; frame < 36000; frame++) {
+        host::advanceMillis(17);
+        group.update();
+        for (auto& servo : servos) {
+            checksum += servo.getValue();
+        }
+
+        if (frame % 500 == 0) {
+            servos[0].playAnimation(frame % 1000 == 0 ? pulse : sweep, PLAY_LOOP);
+            servos[1].crossfadeTo(frame % 1000 == 0 ? sweep : pulse, 300, PLAY_LOOP);
+            leds[0].pause();
+        }
+        if (frame % 500 == 250) {
+            leds[0].resume();
+        }
+        checksum += servos[0].getCurrentAnimationName().length();
+        checksum += servos[2].getAnimationName(1).length();
+        checksum += servos[3].timeToNextKey() + servos[3].timeRemaining();
+    }
+    counting = false;
+    bench::keep(checksum);
+
+    runner.report("frames=36000 servos=4 leds=2", allocations, "allocations");
+    if (allocations != 0) {
+        runner.fail("frames=36000 servos=4 leds=2", "heap allocation after setup");
+    }
+}
@@ -0,0 +1,140 @@
+// bench_bake.cpp
+// Baked lookup-table playback (KeyframeAnimation::bake()) against live
+// interpolation, in both engines: evaluation cost, table memory and the
+// largest difference from the live curve
+
+#include "bench.h"
+#include "engines.h"
+
+#include <cmath>
+#include <cstdio>
+#include <string>
+
+namespace {
+
+const int KEYFRAME_COUNTS[] = {16, 256};
+const unsigned long DURATION_MS = 10000;
+
+// Same deterministic curve as fixtures::makeCurve(), for either engine
+template <typename Animation>
+Animation makeCurve(int keyframeCount) {
+    Animation animation("curve");
+    unsigned long seed = 12345;
+    for (int i = 0; i < keyframeCount; i++) {
+        seed = seed * 1103515245UL + 12345UL;
+        float value = static_cast<float>((seed >> 16) % 181);
+        animation.addKeyFrame(value, DURATION_MS * i / (keyframeCount - 1));
+    }
+    return animation;
+}
+
+float toFloat(float sample) {
+    return sample;
+}
+
+float toFloat(int32_t sample) {
+    return sample / 65536.0f;
+}
+
+// Playback time in each engine's position format
+float toPosition(float ms, float) {
+    return ms;
+}
+
+uint32_t toPosition(float ms, uint32_t) {
+    return static_cast<uint32_t>(ms * 256.0f);
+}
+
+std::string label(const char* engine, const char* playback, unsigned long step, int keyframes) {
+    char text[96];
+    if (step == 0) {
+        std::snprintf(text, sizeof(text), "engine=%s playback=%s kf=%d", engine, playback, keyframes);
+    } else {
+        std::snprintf(text, sizeof(text), "engine=%s playback=%s step=%lums kf=%d",
+                      engine, playback, step, keyframes);
+    }
+    return text;
+}
+
+// Times every playback of one engine, then checks each against the
+// live curve on a 0.1 ms sweep
+template <typename Animation, typename Position>
+void measureEngine(bench::Runner& runner, const char* engine) {
+    const unsigned long STEPS[] = {1, 8};
+    for (int keyframes : KEYFRAME_COUNTS) {
+        Animation live = makeCurve<Animation>(keyframes);
+
+        // 0.25 ms per frame, as a tight loop() would play it
+        Position frameStep = toPosition(0.25f, Position());
+        Position end = toPosition(static_cast<float>(DURATION_MS), Position());
+        Position time = 0;
+        int segment = 0;
+        runner.measure(label(engine, "live", 0, keyframes), 1, [&]() {
+            time += frameStep;
+            if (time >= end) {
+                time = 0;
+            }
+            bench::keep(toFloat(live.sampleAt(time, segment)));
+        });
+
+        for (unsigned long step : STEPS) {
+            for (int interpolate = 0; interpolate < 2; interpolate++) {
+                const char* playback = interpolate ? "lerp" : "nearest";
+                Animation baked = live;
+                if (!baked.bake(step, 20000, interpolate != 0)) {
+                    runner.fail(label(engine, playback, step, keyframes), "bake() refused a table within its budget");
+                    continue;
+                }
+
+                time = 0;
+                segment = 0;
+                runner.measure(label(engine, playback, step, keyframes), 1, [&]() {
+                    time += frameStep;
+                    if (time >= end) {
+                        time = 0;
+                    }
+                    bench::keep(toFloat(baked.sampleAt(time, segment)));
+                });
+
+                float maxError = 0;
+                int liveSegment = 0;
+                int bakedSegment = 0;
+                for (float ms = 0; ms <= DURATION_MS; ms += 0.1f) {
+                    Position position = toPosition(ms, Position());
+                    float error = std::fabs(toFloat(live.sampleAt(position, liveSegment)) -
+                                            toFloat(baked.sampleAt(position, bakedSegment)));
+                    maxError = std::fmax(maxError, error);
+                    if (bakedSegment != liveSegment) {
+                        runner.fail(label(engine, playback, step, keyframes), "keyframe cursor differs from live playback");
+                        break;
+                    }
+                }
+                runner.report(label(engine, playback, step, keyframes), maxError, "max difference from live");
+                runner.report(label(engine, playback, step, keyframes), baked.getBakedBytes(), "bytes");
+            }
+        }
+    }
+}
+
+} // namespace
+
+YBN_BENCH(bakedPlayback) {
+    measureEngine<ybn_float::KeyframeAnimation, float>(runner, "float");
+    measureEngine<ybn_fixed::KeyframeAnimation, uint32_t>(runner, "fixed");
+}
+
+YBN_BENCH(bakeBudget) {
+    // A table over budget is refused and nothing is kept; edits drop it
+    ybn_float::KeyframeAnimation curve = makeCurve<ybn_float::KeyframeAnimation>(16);
+    if (curve.bake(1, 1000) || curve.isBaked() || curve.getBakedBytes() != 0) {
+        runner.fail("overBudget", "10 s at 1 ms must not fit in 1000 entries");
+    }
+    if (!curve.bake(10, 1001) || curve.getBakedBytes() != 1001 * sizeof(float)) {
+        runner.fail("withinBudget", "10 s at 10 ms needs exactly 1001 entries");
+    }
+    runner.report("step=10ms", curve.getBakedBytes(), "bytes");
+    curve.setKeyFrameValue(3, 42.0f);
+    if (curve.isBaked() || curve.getBakedBytes() != 0) {
+        runner.fail("edit", "changing a keyframe must drop the table");
+    }
+}
@@ -0,0 +1,244 @@
+// bench_crossfade.cpp
+// Crossfades that keep both animations playing: the mix against the
+// two curves evaluated separately, the hand-over when the blend ends,
+// and the cost of an update while blending
+
+#include "bench.h"
+#include "fixtures.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+
+const unsigned long FADE_AT_MS = 4000;
+const unsigned long BLEND_MS = 1000;
+const unsigned long CHECK_UNTIL_MS = 7000;
+
+// Largest per-channel difference between two packed colours
+int colorDifference(uint32_t a, uint32_t b) {
+    int largest = 0;
+    for (int shift = 0; shift <= 16; shift += 8) {
+        int difference = std::abs(static_cast<int>((a >> shift) & 0xFF) - static_cast<int>((b >> shift) & 0xFF));
+        largest = difference > largest ? difference : largest;
+    }
+    return largest;
+}
+
+} // namespace
+
+YBN_BENCH(crossfadeMix) {
+    KeyframeAnimation from = fixtures::makeCurve("from", 16);
+    KeyframeAnimation to = fixtures::makeCurve("to", 7);
+    ServoNotifier servo;
+    host::setMicros(0);
+    servo.playAnimation(from, PLAY_LOOP);
+
+    // Both curves keep moving during the blend, and the target carries on
+    // from where it got to once the blend ends
+    int fromSegment = 0;
+    int toSegment = 0;
+    int largestError = 0;
+    for (unsigned long ms = 0; ms <= CHECK_UNTIL_MS; ms++) {
+        host::setMicros(ms * 1000);
+        if (ms == FADE_AT_MS) {
+            servo.update();
+            servo.crossfadeTo(to, BLEND_MS, PLAY_LOOP);
+        }
+        servo.update();
+        if (ms < FADE_AT_MS) {
+            continue;
+        }
+        float target = to.valueAt(ms - FADE_AT_MS, toSegment);
+        float expected = target;
+        if (ms < FADE_AT_MS + BLEND_MS) {
+            float weight = static_cast<float>(ms - FADE_AT_MS) / BLEND_MS;
+            float outgoing = from.valueAt(ms, fromSegment);
+            expected = outgoing + (target - outgoing) * weight;
+        }
+        int error = std::abs(servo.getValue() - static_cast<int>(std::lround(expected)));
+        largestError = error > largestError ? error : largestError;
+    }
+    runner.report("servo", largestError, "max difference from the two curves");
+    if (largestError > 1 || servo.isBlendingAnimations()) {
+        runner.fail("servo", "crossfade does not follow both animations");
+    }
+
+    // Colours: the mix of what both animations show at the time
+    RGBKeyframeAnimation warm("warm");
+    warm.addKeyFrame(255, 0, 0, 0);
+    warm.addKeyFrame(255, 160, 0, 2000);
+    RGBKeyframeAnimation cool("cool");
+    cool.addKeyFrame(0, 40, 255, 0);
+    cool.addKeyFrame(0, 255, 120, 2000);
+    RGBNotifier light;
+    host::setMicros(0);
+    light.playAnimation(warm, PLAY_ONCE);
+    host::setMicros(500 * 1000);
+    light.update();
+    light.crossfadeTo(cool, BLEND_MS, PLAY_ONCE);
+    host::setMicros(1000 * 1000);
+    light.update();
+    int warmSegment = 0;
+    int coolSegment = 0;
+    uint32_t expected = lerpColor(warm.getAnimation().colorAt(warm.getAnimation().valueAt(1000, warmSegment)),
+                                  cool.getAnimation().colorAt(cool.getAnimation().valueAt(500, coolSegment)),
+                                  128);
+    int colorError = colorDifference(light.getColor(), expected);
+    runner.report("rgb", colorError, "max channel difference");
+    if (colorError > 1) {
+        runner.fail("rgb", "colour crossfade does not follow both animations");
+    }
+
+    // Crossfading again mid-blend starts from the mix being output
+    KeyframeAnimation low("low");
+    low.addKeyFrame(0, 0);
+    low.addKeyFrame(0, 1000);
+    KeyframeAnimation high("high");
+    high.addKeyFrame(180, 0);
+    high.addKeyFrame(180, 1000);
+    KeyframeAnimation mid("mid");
+    mid.addKeyFrame(90, 0);
+    mid.addKeyFrame(90, 1000);
+    ServoNotifier refade;
+    host::setMicros(0);
+    refade.playAnimation(low, PLAY_LOOP);
+    refade.update();
+    refade.crossfadeTo(high, BLEND_MS, PLAY_LOOP);
+    int largestJump = 0;
+    int previous = refade.getValue();
+    for (unsigned long ms = 1; ms <= 3000; ms++) {
+        host::setMicros(ms * 1000);
+        refade.update();
+        if (ms == 500) {
+            refade.crossfadeTo(mid, BLEND_MS, PLAY_LOOP);
+            refade.update();
+        }
+        int jump = std::abs(refade.getValue() - previous);
+        largestJump = jump > largestJump ? jump : largestJump;
+        previous = refade.getValue();
+    }
+    runner.report("refade", largestJump, "largest step between 1 ms frames");
+    if (largestJump > 1 || refade.getValue() != 90) {
+        runner.fail("refade", "a crossfade started mid-blend jumps");
+    }
+
+    RGBKeyframeAnimation amber("amber");
+    amber.addKeyFrame(255, 120, 0, 0);
+    amber.addKeyFrame(255, 120, 0, 2000);
+    host::setMicros(0);
+    light.playAnimation(warm, PLAY_LOOP);
+    host::setMicros(1000 * 1000);
+    light.update();
+    light.crossfadeTo(cool, BLEND_MS, PLAY_LOOP);
+    host::setMicros(1500 * 1000);
+    light.update();
+    uint32_t mixed = light.getColor();
+    light.crossfadeTo(amber, BLEND_MS, PLAY_LOOP);
+    light.update();
+    colorError = colorDifference(light.getColor(), mixed);
+    runner.report("rgbRefade", colorError, "max channel jump");
+    if (colorError > 1) {
+        runner.fail("rgbRefade", "a colour crossfade started mid-blend jumps");
+    }
+
+    // Crossfading from a finished ONCE animation fades from where it
+    // came to rest, on its own and in a group
+    KeyframeAnimation rest("rest");
+    rest.addKeyFrame(0, 0);
+    rest.addKeyFrame(90, 1000);
+    for (int grouped = 0; grouped < 2; grouped++) {
+        ServoNotifier finished;
+        NotifierGroup group;
+        if (grouped) {
+            group.add(finished);
+        }
+        host::setMicros(0);
+        finished.playAnimation(rest, PLAY_ONCE);
+        int largestRestError = 0;
+        for (unsigned long ms = 0; ms <= 4000; ms += 10) {
+            host::setMicros(ms * 1000);
+            if (ms == 2000) {
+                finished.crossfadeTo(high, BLEND_MS, PLAY_LOOP);
+            }
+            if (grouped) {
+                group.update();
+            } else {
+                finished.update();
+            }
+            if (ms < 2000) {
+                continue;
+            }
+            float weight = ms < 2000 + BLEND_MS ? static_cast<float>(ms - 2000) / BLEND_MS : 1;
+            int error = std::abs(finished.getValue() - static_cast<int>(std::lround(90 + 90 * weight)));
+            largestRestError = error > largestRestError ? error : largestRestError;
+        }
+        const char* label = grouped ? "finishedGroup" : "finished";
+        runner.report(label, largestRestError, "max difference from the blend");
+        if (largestRestError > 1 || finished.isBlendingAnimations() || finished.getCurrentAnimationName() != "high") {
+            runner.fail(label, "a crossfade from a finished animation does not run");
+        }
+    }
+
+    // A crossfade started while paused begins when play resumes, with
+    // the outgoing animation carrying on from where it was paused
+    ServoNotifier paused;
+    host::setMicros(0);
+    paused.playAnimation(from, PLAY_LOOP);
+    int largestPauseError = 0;
+    fromSegment = 0;
+    toSegment = 0;
+    for (unsigned long ms = 0; ms <= 3500; ms++) {
+        host::setMicros(ms * 1000);
+        if (ms == 1000) {
+            paused.pause();
+        } else if (ms == 1200) {
+            paused.crossfadeTo(to, BLEND_MS, PLAY_LOOP);
+        } else if (ms == 1500) {
+            paused.resume();
+        }
+        paused.update();
+        if (ms < 1500) {
+            continue;
+        }
+        float target = to.valueAt(ms - 1500, toSegment);
+        float expected = target;
+        if (ms < 1500 + BLEND_MS) {
+            float weight = static_cast<float>(ms - 1500) / BLEND_MS;
+            float outgoing = from.valueAt(ms - 500, fromSegment);
+            expected = outgoing + (target - outgoing) * weight;
+        }
+        int error = std::abs(paused.getValue() - static_cast<int>(std::lround(expected)));
+        largestPauseError = error > largestPauseError ? error : largestPauseError;
+    }
+    runner.report("paused", largestPauseError, "max difference from the two curves");
+    if (largestPauseError > 1) {
+        runner.fail("paused", "a crossfade started while paused does not blend from the resume");
+    }
+}
+
+YBN_BENCH(crossfadeUpdate) {
+    // An update while blending evaluates two animations, each from its
+    // own segment cursor
+    const int KEYFRAME_COUNTS[] = {16, 256};
+    for (int keyframes : KEYFRAME_COUNTS) {
+        KeyframeAnimation from = fixtures::makeCurve("from", keyframes);
+        KeyframeAnimation to = fixtures::makeCurve("to", keyframes / 2);
+        for (int blending = 0; blending < 2; blending++) {
+            ServoNotifier servo;
+            host::setMicros(0);
+            servo.playAnimation(from, PLAY_LOOP);
+            if (blending) {
+                servo.crossfadeTo(to, 0xFFFFFFUL, PLAY_LOOP);
+            }
+            char label[64];
+            std::snprintf(label, sizeof(label), "state=%s kf=%d", blending ? "crossfading" : "playing", keyframes);
+            runner.measure(label, 1, [&]() {
+                host::advanceMillis(1);
+                servo.update();
+                bench::keep(static_cast<long>(servo.getValue()));
+            });
+        }
+    }
+}
@@ -0,0 +1,143 @@
+// bench_easing.cpp
+// Per-segment easing: evaluation cost of each easing in both engines,
+// agreement between them and with sampleRange(), and a smooth 5-keyframe
+// curve against the 50 linear keyframes it replaces
+
+#include "bench.h"
+#include "engines.h"
+
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+
+const unsigned long DURATION_MS = 10000;
+const float SMOOTH_VALUES[] = {90, 170, 20, 140, 90};
+const int SMOOTH_COUNT = sizeof(SMOOTH_VALUES) / sizeof(SMOOTH_VALUES[0]);
+
+const char* easingName(int easing) {
+    const char* names[] = {"LINEAR", "STEP", "EASE_IN", "EASE_OUT", "EASE_IN_OUT", "BEZIER", "CATMULL_ROM"};
+    return names[easing];
+}
+
+// Five keyframes over 10 s, every segment eased the same way
+template <typename Animation, typename Easing>
+Animation makeSmooth(Easing easing) {
+    Animation animation("smooth");
+    for (int i = 0; i < SMOOTH_COUNT; i++) {
+        animation.addKeyFrame(SMOOTH_VALUES[i], DURATION_MS * i / (SMOOTH_COUNT - 1), easing);
+    }
+    if (static_cast<int>(easing) == static_cast<int>(ybn_float::BEZIER)) {
+        for (int i = 1; i < SMOOTH_COUNT; i++) {
+            animation.setKeyFrameBezier(i, 0.1f, 1.2f);   // Slight overshoot
+        }
+    }
+    return animation;
+}
+
+std::string label(const char* engine, int easing) {
+    char text[64];
+    std::snprintf(text, sizeof(text), "engine=%s easing=%s", engine, easingName(easing));
+    return text;
+}
+
+} // namespace
+
+YBN_BENCH(easingEvaluate) {
+    for (int easing = ybn_float::LINEAR; easing <= ybn_float::CATMULL_ROM; easing++) {
+        ybn_float::KeyframeAnimation floatCurve =
+            makeSmooth<ybn_float::KeyframeAnimation>(static_cast<ybn_float::Easing>(easing));
+        ybn_fixed::KeyframeAnimation fixedCurve =
+            makeSmooth<ybn_fixed::KeyframeAnimation>(static_cast<ybn_fixed::Easing>(easing));
+
+        // Sequential sweep at 0.25 ms per frame
+        float floatTime = 0;
+        int floatSegment = 0;
+        runner.measure(label("float", easing), 1, [&]() {
+            floatTime += 0.25f;
+            if (floatTime >= DURATION_MS) {
+                floatTime = 0;
+            }
+            bench::keep(floatCurve.sampleAt(floatTime, floatSegment));
+        });
+
+        uint32_t fixedTime = 0;
+        int fixedSegment = 0;
+        runner.measure(label("fixed", easing), 1, [&]() {
+            fixedTime += 64;   // 0.25 ms in Q24.8
+            if (fixedTime >= (DURATION_MS << 8)) {
+                fixedTime = 0;
+            }
+            bench::keep(static_cast<long>(fixedCurve.sampleAt(fixedTime, fixedSegment)));
+        });
+
+        // Q16.16 against float, and sampleRange() against valueAt()
+        const int SAMPLES = 40001;
+        std::vector<float> batch(SAMPLES);
+        floatCurve.sampleRange(0, 0.25f, SAMPLES, batch.data());
+        float fixedError = 0;
+        float batchError = 0;
+        floatSegment = 0;
+        fixedSegment = 0;
+        for (int i = 0; i < SAMPLES; i++) {
+            float value = floatCurve.valueAt(i * 0.25f, floatSegment);
+            float fixedValue = ybn_fixed::fromFixed(fixedCurve.sampleAt(i * 64, fixedSegment));
+            fixedError = std::fmax(fixedError, std::fabs(value - fixedValue));
+            batchError = std::fmax(batchError, std::fabs(value - batch[i]));
+        }
+        runner.report(label("fixed", easing), fixedError, "max difference from float");
+        runner.report(label("sampleRange", easing), batchError, "max difference from valueAt");
+        if (fixedError > 0.05f || batchError > 0.001f) {
+            runner.fail(label("float", easing), "engines or sampleRange() disagree");
+        }
+
+        // Every easing must still pass through its keyframes
+        for (int i = 0; i < SMOOTH_COUNT; i++) {
+            floatSegment = 0;
+            float value = floatCurve.valueAt(DURATION_MS * i / (SMOOTH_COUNT - 1), floatSegment);
+            if (std::fabs(value - SMOOTH_VALUES[i]) > 0.001f) {
+                runner.fail(label("float", easing), "curve misses a keyframe");
+            }
+        }
+    }
+}
+
+YBN_BENCH(easedVsDense) {
+    // The smooth curve, and the 50 linear keyframes it would take to
+    // approximate it without easing
+    const int DENSE_COUNT = 50;
+    ybn_float::KeyframeAnimation smooth("smooth");
+    for (int i = 0; i < SMOOTH_COUNT; i++) {
+        smooth.addKeyFrame(SMOOTH_VALUES[i], DURATION_MS * i / (SMOOTH_COUNT - 1), ybn_float::CATMULL_ROM);
+    }
+    ybn_float::KeyframeAnimation dense("dense");
+    for (int i = 0; i < DENSE_COUNT; i++) {
+        unsigned long time = DURATION_MS * i / (DENSE_COUNT - 1);
+        int segment = 0;
+        dense.addKeyFrame(smooth.valueAt(time, segment), time);
+    }
+
+    float maxError = 0;
+    int smoothSegment = 0;
+    int denseSegment = 0;
+    for (float time = 0; time <= DURATION_MS; time += 0.5f) {
+        maxError = std::fmax(maxError, std::fabs(smooth.valueAt(time, smoothSegment) -
+                                                 dense.valueAt(time, denseSegment)));
+    }
+    runner.report("curve=dense kf=50", maxError, "max difference from smooth");
+
+    const ybn_float::KeyframeAnimation* animations[] = {&smooth, &dense};
+    const char* labels[] = {"curve=smooth kf=5", "curve=dense kf=50"};
+    for (int a = 0; a < 2; a++) {
+        ybn_float::ServoNotifier servo;
+        host::setMicros(0);
+        servo.playAnimation(*animations[a], ybn_float::PLAY_LOOP);
+        runner.measure(labels[a], 1, [&]() {
+            host::advanceMillis(1);
+            servo.update();
+            bench::keep(static_cast<long>(servo.getValue()));
+        });
+    }
+}
@@ -0,0 +1,309 @@
+// bench_events.cpp
+// Event callbacks: the events a servo reports updated every millisecond
+// against the list worked out from the keyframe times, and on jittery
+// frames with stalls against the same, in every mode and both engines;
+// single frames that skip keyframes and passes, seeks across wraps,
+// callbacks that chain animations, and the cost of update() with a
+// callback set
+
+#include "bench.h"
+#include "engines.h"
+
+#include <cstdio>
+#include <utility>
+#include <vector>
+
+namespace {
+
+typedef std::vector<std::pair<int, long>> EventLog;
+
+const unsigned long RUN_MS = 20000;
+const unsigned long CROSSFADE_AT_MS = 600;
+const unsigned long BLEND_MS = 400;
+const int KEYFRAME = 1, WRAP = 2, CROSSFADE_END = 4, COMPLETE = 8;   // NotifierEvent in either engine
+
+template <typename Animation>
+Animation makeCurve(const char* name, int keyframeCount, unsigned long duration, unsigned long seed) {
+    Animation animation(name);
+    for (int i = 0; i < keyframeCount; i++) {
+        seed = seed * 1103515245UL + 12345UL;
+        float value = static_cast<float>((seed >> 16) % 181);
+        animation.addKeyFrame(value, duration * i / (keyframeCount - 1));
+    }
+    return animation;
+}
+
+template <typename Base, typename Event>
+void record(Base&, Event event, long detail, void* context) {
+    static_cast<EventLog*>(context)->push_back(std::make_pair(static_cast<int>(event), detail));
+}
+
+// Keyframe times of makeCurve()
+std::vector<unsigned long> curveTimes(int keyframeCount, unsigned long duration) {
+    std::vector<unsigned long> times;
+    for (int i = 0; i < keyframeCount; i++) {
+        times.push_back(duration * i / (keyframeCount - 1));
+    }
+    return times;
+}
+
+// The events play() must report with 1 ms frames, from the keyframe
+// times alone: keyframes of the first curve up to the crossfade, none
+// during it, then the second curve from where the blend left it. Each
+// pass reaches keyframes 1 to last going forward and last - 1 to 0 in
+// reverse, and its final keyframe comes just before the wrap
+EventLog expectedEvents(int mode) {
+    EventLog log;
+    std::vector<unsigned long> first = curveTimes(12, 1000);
+    for (int k = 1; k < 12 && first[k] <= CROSSFADE_AT_MS; k++) {
+        log.push_back(std::make_pair(KEYFRAME, static_cast<long>(k)));
+    }
+    log.push_back(std::make_pair(CROSSFADE_END, 0L));
+
+    std::vector<unsigned long> times = curveTimes(7, 1300);
+    int last = 6;
+    unsigned long duration = times[last];
+    unsigned long from = BLEND_MS;                   // Second curve position at the end of the blend
+    unsigned long to = RUN_MS - CROSSFADE_AT_MS;     // And at the last frame
+    if (mode == 0) {
+        for (int k = 1; k <= last; k++) {
+            if (times[k] > from) {
+                log.push_back(std::make_pair(KEYFRAME, static_cast<long>(k)));
+            }
+        }
+        log.push_back(std::make_pair(COMPLETE, 0L));
+        return log;
+    }
+    for (unsigned long pass = 0; pass * duration <= to; pass++) {
+        bool reversing = mode == 2 && (pass & 1);
+        for (int step = 1; step <= last; step++) {
+            int k = reversing ? last - step : step;
+            unsigned long at = pass * duration + (reversing ? duration - times[k] : times[k]);
+            if (at > from && at <= to) {
+                log.push_back(std::make_pair(KEYFRAME, static_cast<long>(k)));
+                if (step == last) {
+                    log.push_back(std::make_pair(WRAP, 1L));
+                }
+            }
+        }
+    }
+    return log;
+}
+
+// Events from one update() that jumps from..to ms, after a seek to seekTo
+// ms (or none, if 0) at from
+template <typename Servo, typename Animation, typename Base, typename Event, typename Mode>
+EventLog jump(Mode mode, unsigned long from, unsigned long to, unsigned long seekTo) {
+    Animation curve = makeCurve<Animation>("events", 12, 1000, 11);
+    EventLog log;
+    Servo servo;
+    servo.setEventCallback(record<Base, Event>, &log);
+    host::setMicros(0);
+    servo.playAnimation(curve, mode);
+    host::setMicros(from * 1000);
+    servo.update();
+    log.clear();
+    if (seekTo != 0) {
+        servo.seek(seekTo);
+        servo.update();
+    }
+    host::setMicros(to * 1000);
+    servo.update();
+    return log;
+}
+
+// Frame times in us: every ms, or 0.5 to 40 ms apart with a 350 ms
+// stall every 40 frames. Both have a frame at the crossfade
+std::vector<unsigned long> makeFrames(bool jittery) {
+    std::vector<unsigned long> frames;
+    unsigned long seed = 99;
+    unsigned long us = 0;
+    while (us <= RUN_MS * 1000) {
+        frames.push_back(us);
+        seed = seed * 1103515245UL + 12345UL;
+        unsigned long step = !jittery ? 1000 : (frames.size() % 40 == 0 ? 350000 : 500 + (seed >> 8) % 39500);
+        if (us < CROSSFADE_AT_MS * 1000 && us + step > CROSSFADE_AT_MS * 1000) {
+            step = CROSSFADE_AT_MS * 1000 - us;
+        }
+        us += step;
+    }
+    return frames;
+}
+
+template <typename Servo, typename Animation, typename Base, typename Event, typename Mode, typename Clock>
+EventLog play(Mode mode, const Clock& micros, bool jittery) {
+    Animation curve = makeCurve<Animation>("events", 12, 1000, 11);
+    Animation settle = makeCurve<Animation>("eventsSettle", 7, 1300, 12);
+    EventLog log;
+    Servo servo;
+    servo.setTimeSource(micros);
+    servo.setEventCallback(record<Base, Event>, &log);
+    host::setMicros(0);
+    servo.playAnimation(curve, mode);
+    for (unsigned long frame : makeFrames(jittery)) {
+        host::setMicros(frame);
+        servo.update();
+        if (frame == CROSSFADE_AT_MS * 1000) {
+            servo.crossfadeTo(settle, BLEND_MS, mode);
+        }
+    }
+    return log;
+}
+
+template <typename Servo, typename Animation, typename Base, typename Event, typename Mode, typename Clock>
+void checkEngine(bench::Runner& runner, const char* engine, const Clock& micros, Mode mode, const char* modeName) {
+    EventLog reference = play<Servo, Animation, Base, Event>(mode, micros, false);
+    EventLog jittery = play<Servo, Animation, Base, Event>(mode, micros, true);
+    EventLog expected = expectedEvents(static_cast<int>(mode));
+    long counts[16] = {0};
+    for (const auto& event : reference) {
+        counts[event.first & 15]++;
+    }
+    char label[64];
+    std::snprintf(label, sizeof(label), "engine=%s mode=%s", engine, modeName);
+    runner.report(label, counts[KEYFRAME], "keyframe events");
+    runner.report(label, counts[WRAP], "wrap events");
+    if (reference != expected) {
+        runner.fail(label, "1 ms frames did not report the expected events in order");
+    }
+    if (jittery != reference) {
+        runner.fail(label, "jittery frames reported different events from 1 ms frames");
+    }
+    if (counts[CROSSFADE_END] != 1 || counts[COMPLETE] != (static_cast<int>(mode) == 0 ? 1 : 0)) {
+        runner.fail(label, "crossfade end or completion not reported exactly once");
+    }
+
+    // One frame across several keyframes, and across whole passes: each
+    // keyframe once, in order, with the wrap between passes. Keyframes at
+    // 0, 90, 181, 272, 363, 454, 545, 636, 727, 818, 909 and 1000 ms
+    struct Jump {
+        const char* name;
+        int mode;
+        unsigned long from, to, seekTo;
+        EventLog events;
+    };
+    std::vector<Jump> jumps;
+    EventLog skipped;
+    for (long k = 1; k <= 8; k++) {
+        skipped.push_back(std::make_pair(KEYFRAME, k));
+    }
+    jumps.push_back(Jump{"skip=8 keyframes", 1, 0, 800, 0, skipped});
+    EventLog passes;
+    for (long k = 1; k <= 11; k++) {
+        passes.push_back(std::make_pair(KEYFRAME, k));
+    }
+    passes.push_back(std::make_pair(WRAP, 2L));
+    for (long k = 1; k <= 3; k++) {
+        passes.push_back(std::make_pair(KEYFRAME, k));
+    }
+    jumps.push_back(Jump{"skip=2 passes", 1, 0, 2300, 0, passes});
+    EventLog turn(passes.begin(), passes.begin() + 11);
+    turn.push_back(std::make_pair(WRAP, 1L));
+    for (long k = 10; k >= 8; k--) {
+        turn.push_back(std::make_pair(KEYFRAME, k));
+    }
+    jumps.push_back(Jump{"skip=turn", 2, 0, 1300, 0, turn});
+
+    // seek() across wraps reports nothing; the next frame carries on
+    // from the new position
+    jumps.push_back(Jump{"seek=wrap", 1, 500, 600, 2300, EventLog(1, std::make_pair(KEYFRAME, 4L))});
+    jumps.push_back(Jump{"seek=turn", 2, 500, 600, 1700, EventLog(1, std::make_pair(KEYFRAME, 3L))});
+    for (const Jump& test : jumps) {
+        if (test.mode != static_cast<int>(mode)) {
+            continue;
+        }
+        EventLog log = jump<Servo, Animation, Base, Event>(mode, test.from, test.to, test.seekTo);
+        std::snprintf(label, sizeof(label), "engine=%s %s", engine, test.name);
+        if (log != test.events) {
+            runner.fail(label, "one frame did not report each event once, in order");
+        }
+    }
+}
+
+// Replays the animation from its completion callback, five times in all
+void replay(ybn_float::NotifierBase& notifier, ybn_float::NotifierEvent event, long, void* context) {
+    int* completions = static_cast<int*>(context);
+    if (event == ybn_float::EVENT_COMPLETE && ++*completions < 5) {
+        notifier.playAnimation("events", ybn_float::PLAY_ONCE);
+    }
+}
+
+} // namespace
+
+YBN_BENCH(eventsExactlyOnce) {
+    const ybn_float::PlayMode floatModes[] = {ybn_float::PLAY_ONCE, ybn_float::PLAY_LOOP, ybn_float::PLAY_BOOMERANG};
+    const ybn_fixed::PlayMode fixedModes[] = {ybn_fixed::PLAY_ONCE, ybn_fixed::PLAY_LOOP, ybn_fixed::PLAY_BOOMERANG};
+    const char* modeNames[] = {"ONCE", "LOOP", "BOOMERANG"};
+    for (int m = 0; m < 3; m++) {
+        checkEngine<ybn_float::ServoNotifier, ybn_float::KeyframeAnimation, ybn_float::NotifierBase,
+                    ybn_float::NotifierEvent>(runner, "float", ybn_float::MICROS_CLOCK, floatModes[m], modeNames[m]);
+        checkEngine<ybn_fixed::ServoNotifier, ybn_fixed::KeyframeAnimation, ybn_fixed::NotifierBase,
+                    ybn_fixed::NotifierEvent>(runner, "fixed", ybn_fixed::MICROS_CLOCK, fixedModes[m], modeNames[m]);
+    }
+
+    // A 3.5 s stall on a 1 s loop: one wrap event for three passes, and
+    // the same passes in all as updating every ms
+    ybn_float::KeyframeAnimation curve = makeCurve<ybn_float::KeyframeAnimation>("events", 12, 1000, 11);
+    long passes[2] = {0, 0};
+    long largestWrap = 0;
+    for (int stall = 0; stall < 2; stall++) {
+        EventLog log;
+        ybn_float::ServoNotifier servo;
+        servo.setEventCallback(record<ybn_float::NotifierBase, ybn_float::NotifierEvent>, &log,
+                               ybn_float::EVENT_WRAP);
+        host::setMicros(0);
+        servo.playAnimation(curve, ybn_float::PLAY_LOOP);
+        for (unsigned long ms = 0; ms <= 10250; ms += (stall && ms == 2200) ? 3500 : 1) {
+            host::setMicros(ms * 1000);
+            servo.update();
+        }
+        for (const auto& event : log) {
+            passes[stall] += event.second;
+            largestWrap = event.second > largestWrap ? event.second : largestWrap;
+        }
+    }
+    runner.report("stall=3500ms", passes[1], "passes wrapped");
+    if (passes[0] != 10 || passes[1] != passes[0] || largestWrap < 3) {
+        runner.fail("stall=3500ms", "wraps lost or repeated across a stall");
+    }
+
+    // A completion callback that plays the animation again
+    int completions = 0;
+    ybn_float::ServoNotifier servo;
+    servo.addAnimation(curve);
+    servo.setEventCallback(replay, &completions, ybn_float::EVENT_COMPLETE);
+    host::setMicros(0);
+    servo.playAnimation("events", ybn_float::PLAY_ONCE);
+    for (unsigned long ms = 0; ms <= 10000; ms += 7) {
+        host::setMicros(ms * 1000);
+        servo.update();
+    }
+    runner.report("chained", completions, "completions");
+    if (completions != 5 || !servo.isCompleted()) {
+        runner.fail("chained", "a callback could not play the next animation");
+    }
+}
+
+YBN_BENCH(eventsUpdate) {
+    // update() at 1 ms frames on a looping 12-keyframe curve, without a
+    // callback and with one taking every event
+    ybn_float::KeyframeAnimation curve = makeCurve<ybn_float::KeyframeAnimation>("events", 12, 1000, 11);
+    const char* labels[] = {"callback=none", "callback=all"};
+    for (int withCallback = 0; withCallback < 2; withCallback++) {
+        EventLog log;
+        log.reserve(1 << 16);
+        ybn_float::ServoNotifier servo;
+        if (withCallback) {
+            servo.setEventCallback(record<ybn_float::NotifierBase, ybn_float::NotifierEvent>, &log);
+        }
+        host::setMicros(0);
+        servo.playAnimation(curve, ybn_float::PLAY_LOOP);
+        runner.measure(labels[withCallback], 1, [&]() {
+            host::advanceMillis(1);
+            servo.update();
+            if (log.size() == log.capacity()) {
+                log.clear();
+            }
+        });
+    }
+}
@@ -0,0 +1,172 @@
+// bench_fixed.cpp
+// Q16.16 engine (YBN_FIXED_POINT=1) against the float engine: output
+// agreement in LSBs and evaluation cost. On the host both run on a
+// hardware FPU, so timings understate the savings on FPU-less boards,
+// where every float operation is a soft-float library call.
+
+#include "bench.h"
+#include "engines.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+
+const int KEYFRAME_COUNTS[] = {2, 16, 256};
+const float SPEEDS[] = {1.0f, 0.37f, 2.5f};
+
+// Long linear segments, where a coarse per-ms slope drifts furthest
+struct LongSegment {
+    float from, to;
+    unsigned long duration;   // ms
+};
+const LongSegment LONG_SEGMENTS[] = {{0, 100, 3600000UL}, {0, 255, 600000UL}, {180, 0, 16000000UL}, {20, 21, 5000000UL}};
+
+// Same deterministic curve as fixtures::makeCurve(), for either engine
+template <typename Animation>
+Animation makeCurve(int keyframeCount) {
+    Animation animation("curve");
+    unsigned long seed = 12345;
+    for (int i = 0; i < keyframeCount; i++) {
+        seed = seed * 1103515245UL + 12345UL;
+        float value = static_cast<float>((seed >> 16) % 181);
+        animation.addKeyFrame(value, 10000UL * i / (keyframeCount - 1));
+    }
+    return animation;
+}
+
+} // namespace
+
+YBN_BENCH(fixedPointAccuracy) {
+    // Drive one float and one fixed notifier through identical jittery
+    // frames and compare getValue() every frame
+    const ybn_float::PlayMode floatModes[] = {ybn_float::PLAY_ONCE, ybn_float::PLAY_LOOP, ybn_float::PLAY_BOOMERANG};
+    const ybn_fixed::PlayMode fixedModes[] = {ybn_fixed::PLAY_ONCE, ybn_fixed::PLAY_LOOP, ybn_fixed::PLAY_BOOMERANG};
+    const char* modeNames[] = {"ONCE", "LOOP", "BOOMERANG"};
+
+    for (int keyframes : KEYFRAME_COUNTS) {
+        for (int mode = 0; mode < 3; mode++) {
+            for (float speed : SPEEDS) {
+                for (int clock = 0; clock < 2; clock++) {
+                    ybn_float::KeyframeAnimation floatCurve = makeCurve<ybn_float::KeyframeAnimation>(keyframes);
+                    ybn_fixed::KeyframeAnimation fixedCurve = makeCurve<ybn_fixed::KeyframeAnimation>(keyframes);
+                    ybn_float::ServoNotifier floatServo;
+                    ybn_fixed::ServoNotifier fixedServo;
+
+                    if (clock == 1) {
+                        floatServo.setTimeSource(ybn_float::MICROS_CLOCK);
+                        fixedServo.setTimeSource(ybn_fixed::MICROS_CLOCK);
+                    }
+                    floatServo.setGlobalSpeed(speed);
+                    fixedServo.setGlobalSpeed(speed);
+                    floatServo.setValueScale(0.75f);
+                    fixedServo.setValueScale(0.75f);
+                    floatServo.setValueOffset(10.5f);
+                    fixedServo.setValueOffset(10.5f);
+
+                    host::setMicros(0);
+                    floatServo.playAnimation(floatCurve, floatModes[mode]);
+                    fixedServo.playAnimation(fixedCurve, fixedModes[mode]);
+
+                    int maxError = 0;
+                    unsigned long seed = 7;
+                    for (int frame = 0; frame < 20000; frame++) {
+                        seed = seed * 1103515245UL + 12345UL;
+                        host::advanceMicros(500 + (seed >> 16) % 4000);
+                        floatServo.update();
+                        fixedServo.update();
+                        int error = std::abs(floatServo.getValue() - fixedServo.getValue());
+                        if (error > maxError) {
+                            maxError = error;
+                        }
+                    }
+
+                    char label[96];
+                    std::snprintf(label, sizeof(label), "kf=%d mode=%s speed=%.2f clock=%s",
+                                  keyframes, modeNames[mode], speed, clock ? "micros" : "millis");
+                    runner.report(label, maxError, "LSB max error");
+                    if (maxError > 1) {
+                        runner.fail(label, "fixed point output more than 1 LSB from float");
+                    }
+                }
+            }
+        }
+    }
+
+    // One long segment sampled every 997 ms against the exact line
+    for (const LongSegment& segment : LONG_SEGMENTS) {
+        ybn_fixed::KeyframeAnimation curve("long");
+        curve.addKeyFrame(segment.from, 0);
+        curve.addKeyFrame(segment.to, segment.duration);
+        int maxError = 0;
+        int index = 0;
+        for (unsigned long ms = 0; ms <= segment.duration; ms += 997) {
+            double exact = segment.from + (segment.to - segment.from) * static_cast<double>(ms) / segment.duration;
+            int value = ybn_fixed::roundSample(curve.sampleAt(static_cast<ybn_fixed::position_t>(ms) << 8, index));
+            int error = std::abs(value - static_cast<int>(std::floor(exact + 0.5)));
+            maxError = error > maxError ? error : maxError;
+        }
+        char label[96];
+        std::snprintf(label, sizeof(label), "segment=%.0f-%.0f over %lums", segment.from, segment.to, segment.duration);
+        runner.report(label, maxError, "LSB max error");
+        if (maxError > 1) {
+            runner.fail(label, "fixed point drifted more than 1 LSB on a long segment");
+        }
+    }
+}
+
+YBN_BENCH(fixedPointEvaluate) {
+    // Evaluation alone: float valueAt() against Q16.16 sampleAt()
+    for (int keyframes : KEYFRAME_COUNTS) {
+        ybn_float::KeyframeAnimation floatCurve = makeCurve<ybn_float::KeyframeAnimation>(keyframes);
+        ybn_fixed::KeyframeAnimation fixedCurve = makeCurve<ybn_fixed::KeyframeAnimation>(keyframes);
+        char label[64];
+
+        float floatTime = 0;
+        int floatSegment = 0;
+        std::snprintf(label, sizeof(label), "engine=float kf=%d", keyframes);
+        runner.measure(label, 1, [&]() {
+            floatTime += 0.25f;
+            if (floatTime >= 10000.0f) {
+                floatTime = 0;
+            }
+            bench::keep(floatCurve.sampleAt(floatTime, floatSegment));
+        });
+
+        uint32_t fixedTime = 0;
+        int fixedSegment = 0;
+        std::snprintf(label, sizeof(label), "engine=fixed kf=%d", keyframes);
+        runner.measure(label, 1, [&]() {
+            fixedTime += 64;   // 0.25 ms in Q24.8
+            if (fixedTime >= (10000UL << 8)) {
+                fixedTime = 0;
+            }
+            bench::keep(static_cast<long>(fixedCurve.sampleAt(fixedTime, fixedSegment)));
+        });
+    }
+}
+
+YBN_BENCH(fixedPointUpdate) {
+    // Full ServoNotifier::update() + getValue() in each engine
+    ybn_float::KeyframeAnimation floatCurve = makeCurve<ybn_float::KeyframeAnimation>(16);
+    ybn_fixed::KeyframeAnimation fixedCurve = makeCurve<ybn_fixed::KeyframeAnimation>(16);
+    ybn_float::ServoNotifier floatServo;
+    ybn_fixed::ServoNotifier fixedServo;
+
+    host::setMicros(0);
+    floatServo.playAnimation(floatCurve, ybn_float::PLAY_LOOP);
+    runner.measure("engine=float kf=16 mode=LOOP", 1, [&]() {
+        host::advanceMillis(1);
+        floatServo.update();
+        bench::keep(static_cast<long>(floatServo.getValue()));
+    });
+
+    host::setMicros(0);
+    fixedServo.playAnimation(fixedCurve, ybn_fixed::PLAY_LOOP);
+    runner.measure("engine=fixed kf=16 mode=LOOP", 1, [&]() {
+        host::advanceMillis(1);
+        fixedServo.update();
+        bench::keep(static_cast<long>(fixedServo.getValue()));
+    });
+}
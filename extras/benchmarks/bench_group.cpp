@@ -0,0 +1,128 @@
+// bench_group.cpp
+// NotifierGroup::update() against a hand-written loop over every
+// registered notifier, with all or only some channels playing, and
+// members that are copied, reallocated or destroyed
+
+#include "bench.h"
+#include "fixtures.h"
+
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+const int CHANNEL_COUNTS[] = {64, 256};
+const int ACTIVE_PERCENT[] = {100, 10};
+
+std::string label(int channels, int activePercent) {
+    char text[64];
+    std::snprintf(text, sizeof(text), "channels=%d active=%d%%", channels, activePercent);
+    return text;
+}
+
+// Start every tenth notifier (or all of them) on a looping curve
+void startChannels(std::vector<ServoNotifier>& notifiers, int activePercent) {
+    KeyframeAnimation curve = fixtures::makeCurve("curve", 16);
+    host::setMicros(0);
+    int stride = 100 / activePercent;
+    for (size_t i = 0; i < notifiers.size(); i += stride) {
+        notifiers[i].playAnimation(curve, PLAY_LOOP);
+    }
+}
+
+} // namespace
+
+YBN_BENCH(groupUpdate) {
+    for (int channels : CHANNEL_COUNTS) {
+        for (int activePercent : ACTIVE_PERCENT) {
+            std::vector<ServoNotifier> notifiers(channels);
+            NotifierGroup group;
+            for (auto& notifier : notifiers) {
+                group.add(notifier);
+            }
+            startChannels(notifiers, activePercent);
+
+            // Cost per registered channel, so both cases share a unit
+            runner.measure(label(channels, activePercent), channels, [&]() {
+                host::advanceMillis(1);
+                group.update();
+                bench::keep(static_cast<long>(notifiers[0].getValue()));
+            });
+        }
+    }
+}
+
+YBN_BENCH(groupManualLoop) {
+    for (int channels : CHANNEL_COUNTS) {
+        for (int activePercent : ACTIVE_PERCENT) {
+            std::vector<ServoNotifier> notifiers(channels);
+            startChannels(notifiers, activePercent);
+
+            runner.measure(label(channels, activePercent), channels, [&]() {
+                host::advanceMillis(1);
+                for (auto& notifier : notifiers) {
+                    notifier.update();
+                }
+                bench::keep(static_cast<long>(notifiers[0].getValue()));
+            });
+        }
+    }
+}
+
+YBN_BENCH(groupMembership) {
+    KeyframeAnimation curve = fixtures::makeCurve("curve", 16);
+    host::setMicros(0);
+
+    // A copy of a member is not in the original's group
+    NotifierGroup first;
+    NotifierGroup second;
+    ServoNotifier original;
+    first.add(original);
+    ServoNotifier copy(original);
+    ServoNotifier assigned;
+    assigned = original;
+    if (!second.add(copy) || !second.add(assigned) || first.getCount() != 1) {
+        runner.fail("copy", "a copy must start outside any group");
+    }
+    original.playAnimation(curve, PLAY_LOOP);
+    copy.playAnimation(curve, PLAY_LOOP);
+    if (first.getActiveCount() != 1 || second.getActiveCount() != 1) {
+        runner.fail("copy", "a copy activated its original's group");
+    }
+
+    // Members that reallocate or go out of scope leave the group, and
+    // the rest keep playing
+    NotifierGroup group;
+    std::vector<ServoNotifier> notifiers(4);
+    for (auto& notifier : notifiers) {
+        group.add(notifier);
+        notifier.playAnimation(curve, PLAY_LOOP);
+    }
+    notifiers.reserve(64);
+    {
+        ServoNotifier scoped;
+        group.add(scoped);
+        scoped.playAnimation(curve, PLAY_LOOP);
+        host::advanceMillis(10);
+        group.update();
+    }
+    for (auto& notifier : notifiers) {
+        group.add(notifier);
+    }
+    notifiers[1].stop();
+    host::advanceMillis(10);
+    group.update();
+    notifiers[1].playAnimation(curve, PLAY_LOOP);
+    for (int frame = 0; frame < 200; frame++) {
+        host::advanceMillis(7);
+        group.update();
+    }
+    runner.report("reallocated", group.getCount(), "members");
+    if (group.getCount() != 4 || group.getActiveCount() != 4) {
+        runner.fail("reallocated", "destroyed notifiers were left in the group");
+    }
+    if (notifiers[0].getValue() != notifiers[2].getValue() || notifiers[3].getValue() != notifiers[0].getValue() ||
+        !notifiers[1].isPlaying()) {
+        runner.fail("reallocated", "moved members stopped updating");
+    }
+}
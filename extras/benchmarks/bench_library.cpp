@@ -0,0 +1,85 @@
+// bench_library.cpp
+// Keyframes held in RAM when many notifiers add the same animation, and
+// the cost of switching animations by name against switching by ID
+
+#include "bench.h"
+#include "fixtures.h"
+
+#include <cstdio>
+#include <vector>
+
+YBN_BENCH(sharedAnimationMemory) {
+    const int counts[] = {1, 8, 30};
+    for (int count : counts) {
+        // Unique name per run so earlier runs don't share the entry
+        char name[32];
+        std::snprintf(name, sizeof(name), "wave%d", count);
+        KeyframeAnimation wave = fixtures::makeCurve(name, 256);
+
+        AnimationLibrary& library = getAnimationLibrary();
+        long keyframesBefore = library.getKeyframeCount();
+
+        std::vector<ServoNotifier> notifiers(count);
+        for (auto& notifier : notifiers) {
+            notifier.addAnimation(wave);
+        }
+
+        char label[64];
+        std::snprintf(label, sizeof(label), "kf=256 notifiers=%d", count);
+        runner.report(label, library.getKeyframeCount() - keyframesBefore, "keyframes stored");
+    }
+}
+
+namespace {
+
+const int ANIMATION_COUNTS[] = {4, 64};
+
+// Registers count animations named clip0, clip1, ... and returns their IDs
+std::vector<AnimationId> addClips(ServoNotifier& notifier, int count) {
+    std::vector<AnimationId> ids;
+    for (int i = 0; i < count; i++) {
+        char name[16];
+        std::snprintf(name, sizeof(name), "clip%d", i);
+        ids.push_back(notifier.addAnimation(fixtures::makeCurve(name, 16)));
+    }
+    return ids;
+}
+
+} // namespace
+
+YBN_BENCH(switchByName) {
+    for (int count : ANIMATION_COUNTS) {
+        ServoNotifier notifier;
+        addClips(notifier, count);
+        // Cycle through names so the lookup can't be cached
+        std::vector<String> names;
+        for (int i = 0; i < count; i++) {
+            names.push_back(String("clip") + String(i));
+        }
+
+        char label[32];
+        std::snprintf(label, sizeof(label), "animations=%d", count);
+        size_t next = 0;
+        runner.measure(label, 1, [&]() {
+            notifier.playAnimation(names[next], PLAY_LOOP);
+            next = (next + 1) % names.size();
+            bench::keep(static_cast<long>(notifier.getState()));
+        });
+    }
+}
+
+YBN_BENCH(switchById) {
+    for (int count : ANIMATION_COUNTS) {
+        ServoNotifier notifier;
+        std::vector<AnimationId> ids = addClips(notifier, count);
+
+        char label[32];
+        std::snprintf(label, sizeof(label), "animations=%d", count);
+        size_t next = 0;
+        runner.measure(label, 1, [&]() {
+            notifier.playAnimation(ids[next], PLAY_LOOP);
+            next = (next + 1) % ids.size();
+            bench::keep(static_cast<long>(notifier.getState()));
+        });
+    }
+}
@@ -0,0 +1,132 @@
+// bench_lookup.cpp
+// Keyframe segment lookup and evaluation: KeyframeAnimation::findSegment()
+// and valueAt() against the linear walk the notifiers used to do
+
+#include "bench.h"
+#include "fixtures.h"
+
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+const int KEYFRAME_COUNTS[] = {16, 256, 4096, 65536};
+
+std::string label(const char* access, int keyframes) {
+    char text[64];
+    std::snprintf(text, sizeof(text), "access=%s kf=%d", access, keyframes);
+    return text;
+}
+
+// Reference: walk forward from the first keyframe through the bounds
+// checked accessor, as calculateCurrentValue() did after a loop wrap.
+// Times that only increase can carry on from the last result
+int linearWalk(const KeyframeAnimation& animation, float time, int from = 0) {
+    int index = from;
+    while (index + 2 < animation.getKeyframeCount() &&
+           time >= animation.getKeyFrameTime(index + 1)) {
+        index++;
+    }
+    return index;
+}
+
+// Pseudo-random probe times spread over the whole curve
+std::vector<float> randomTimes(int count) {
+    std::vector<float> times(count);
+    unsigned long seed = 99;
+    for (int i = 0; i < count; i++) {
+        seed = seed * 1103515245UL + 12345UL;
+        times[i] = static_cast<float>((seed >> 8) % (fixtures::CURVE_DURATION_MS * 100)) / 100.0f;
+    }
+    return times;
+}
+
+void checkLookups(bench::Runner& runner, const std::string& name, long mismatches) {
+    runner.report(name, mismatches, "lookups differing from the linear walk");
+    if (mismatches != 0) {
+        runner.fail(name, "findSegment() differs from the linear walk");
+    }
+}
+
+} // namespace
+
+YBN_BENCH(findSegmentSequential) {
+    for (int keyframes : KEYFRAME_COUNTS) {
+        KeyframeAnimation curve = fixtures::makeCurve("curve", keyframes);
+
+        // Every query of one pass, as measured below
+        long mismatches = 0;
+        int segment = 0;
+        int expected = 0;
+        for (float time = 0.25f; time < fixtures::CURVE_DURATION_MS; time += 0.25f) {
+            segment = curve.findSegment(time, segment);
+            expected = linearWalk(curve, time, expected);
+            mismatches += segment != expected;
+        }
+        checkLookups(runner, label("sequential", keyframes), mismatches);
+
+        float time = 0;
+        segment = 0;
+        runner.measure(label("sequential", keyframes), 1, [&]() {
+            time += 0.25f;
+            if (time >= fixtures::CURVE_DURATION_MS) {
+                time = 0;
+            }
+            segment = curve.findSegment(time, segment);
+            bench::keep(static_cast<long>(segment));
+        });
+    }
+}
+
+YBN_BENCH(findSegmentRandom) {
+    std::vector<float> times = randomTimes(1024);
+    for (int keyframes : KEYFRAME_COUNTS) {
+        KeyframeAnimation curve = fixtures::makeCurve("curve", keyframes);
+        long mismatches = 0;
+        int segment = 0;
+        for (size_t probe = 0; probe < times.size(); probe++) {
+            segment = curve.findSegment(times[probe], segment);
+            mismatches += segment != linearWalk(curve, times[probe]);
+        }
+        checkLookups(runner, label("random", keyframes), mismatches);
+
+        size_t probe = 0;
+        segment = 0;
+        runner.measure(label("random", keyframes), 1, [&]() {
+            probe = (probe + 1) & 1023;
+            segment = curve.findSegment(times[probe], segment);
+            bench::keep(static_cast<long>(segment));
+        });
+    }
+}
+
+YBN_BENCH(linearWalkRandom) {
+    std::vector<float> times = randomTimes(1024);
+    for (int keyframes : KEYFRAME_COUNTS) {
+        if (keyframes > 4096) {
+            continue;   // Too slow to be worth waiting for
+        }
+        KeyframeAnimation curve = fixtures::makeCurve("curve", keyframes);
+        size_t probe = 0;
+        runner.measure(label("random", keyframes), 1, [&]() {
+            probe = (probe + 1) & 1023;
+            bench::keep(static_cast<long>(linearWalk(curve, times[probe])));
+        });
+    }
+}
+
+YBN_BENCH(valueAtSequential) {
+    // Lookup plus evaluation: one multiply-add on the precomputed slope
+    for (int keyframes : KEYFRAME_COUNTS) {
+        KeyframeAnimation curve = fixtures::makeCurve("curve", keyframes);
+        float time = 0;
+        int segment = 0;
+        runner.measure(label("sequential", keyframes), 1, [&]() {
+            time += 0.25f;
+            if (time >= fixtures::CURVE_DURATION_MS) {
+                time = 0;
+            }
+            bench::keep(curve.valueAt(time, segment));
+        });
+    }
+}
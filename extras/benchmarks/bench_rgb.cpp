@@ -0,0 +1,161 @@
+// bench_rgb.cpp
+// One RGBNotifier against three LEDNotifiers, one per channel, which
+// is how an RGB light was animated before RGBNotifier existed
+
+#include "bench.h"
+#include "fixtures.h"
+
+#include <cstdio>
+#include <type_traits>
+#include <utility>
+
+namespace {
+
+const int KEYFRAME_COUNTS[] = {2, 16, 256};
+
+// Same keyframes as fixtures::makeCurve(), one curve per channel
+struct ChannelCurves {
+    KeyframeAnimation red;
+    KeyframeAnimation green;
+    KeyframeAnimation blue;
+    RGBKeyframeAnimation color;
+
+    explicit ChannelCurves(int keyframes)
+        : red(fixtures::makeCurve("red", keyframes)),
+          green(fixtures::makeCurve("green", keyframes)),
+          blue(fixtures::makeCurve("blue", keyframes)),
+          color("color") {
+        for (int i = 0; i < keyframes; i++) {
+            color.addKeyFrame(red.getKeyFrameValue(keyframes - 1 - i),
+                              green.getKeyFrameValue(i),
+                              blue.getKeyFrameValue(i / 2),
+                              red.getKeyFrameTime(i));
+        }
+    }
+};
+
+// Plain animations have no colours, so RGBNotifier must not take them
+template <typename Light, typename = void>
+struct PlaysPlainAnimations : std::false_type {};
+
+template <typename Light>
+struct PlaysPlainAnimations<Light, decltype(std::declval<Light&>().playAnimation(
+                                       std::declval<const KeyframeAnimation&>()))> : std::true_type {};
+
+static_assert(!PlaysPlainAnimations<RGBNotifier>::value, "RGBNotifier plays animations without colours");
+static_assert(PlaysPlainAnimations<LEDNotifier>::value, "PlaysPlainAnimations no longer detects playAnimation()");
+
+std::string label(const char* engine, int keyframes) {
+    char text[64];
+    std::snprintf(text, sizeof(text), "engine=%s kf=%d", engine, keyframes);
+    return text;
+}
+
+} // namespace
+
+YBN_BENCH(rgbUpdate) {
+    for (int keyframes : KEYFRAME_COUNTS) {
+        ChannelCurves curves(keyframes);
+        host::setMicros(0);
+
+        RGBNotifier light(3, 5, 6);
+        light.playAnimation(curves.color, PLAY_LOOP);
+        runner.measure(label("rgb", keyframes), 1, [&]() {
+            host::advanceMillis(1);
+            light.update();
+            bench::keep(static_cast<long>(light.getColor()));
+        });
+
+        LEDNotifier red(3, ANALOG);
+        LEDNotifier green(5, ANALOG);
+        LEDNotifier blue(6, ANALOG);
+        red.playAnimation(curves.red, PLAY_LOOP);
+        green.playAnimation(curves.green, PLAY_LOOP);
+        blue.playAnimation(curves.blue, PLAY_LOOP);
+        runner.measure(label("3xled", keyframes), 1, [&]() {
+            host::advanceMillis(1);
+            unsigned long now = millis();
+            red.update(now);
+            green.update(now);
+            blue.update(now);
+            bench::keep(static_cast<long>(red.getValue()));
+        });
+    }
+}
+
+YBN_BENCH(rgbGroup) {
+    // RGBNotifiers in a NotifierGroup against the same lights updated
+    // on their own: frames where the colours differ
+    const int LIGHTS = 8;
+    ChannelCurves curves(16);
+    host::setMicros(0);
+
+    RGBNotifier grouped[LIGHTS];
+    RGBNotifier alone[LIGHTS];
+    NotifierGroup group;
+    for (int i = 0; i < LIGHTS; i++) {
+        group.add(grouped[i]);
+        PlayMode mode = i % 2 == 0 ? PLAY_LOOP : PLAY_ONCE;
+        grouped[i].playAnimation(curves.color, mode);
+        alone[i].playAnimation(curves.color, mode);
+    }
+
+    long mismatches = 0;
+    unsigned long duration = curves.red.getKeyFrameTime(15);
+    for (unsigned long frame = 0; frame < 2 * duration; frame += 7) {
+        if (frame == duration) {
+            grouped[1].crossfadeTo(curves.color, 200, PLAY_BOOMERANG);
+            alone[1].crossfadeTo(curves.color, 200, PLAY_BOOMERANG);
+        }
+        host::advanceMillis(7);
+        unsigned long now = millis();
+        group.update(now);
+        for (int i = 0; i < LIGHTS; i++) {
+            alone[i].update(now);
+            mismatches += grouped[i].getColor() != alone[i].getColor();
+        }
+    }
+    runner.report("mismatched frames", mismatches, "frames");
+    if (mismatches != 0) {
+        runner.fail("group", "grouped RGB lights differ from lights updated alone");
+    }
+    if (group.getCount() != LIGHTS) {
+        runner.fail("group", "RGB lights were not added");
+    }
+
+    runner.measure("group lights=8", LIGHTS, [&]() {
+        host::advanceMillis(1);
+        group.update();
+        bench::keep(static_cast<long>(grouped[0].getColor()));
+    });
+}
+
+YBN_BENCH(rgbKinds) {
+    // IDs are shared by every notifier, so a plain animation's ID must
+    // not play on an RGB light, nor a colour animation's on a servo
+    ChannelCurves curves(4);
+    RGBNotifier light;
+    ServoNotifier servo;
+    AnimationId plainId = servo.addAnimation(curves.red);
+    AnimationId colorId = light.addAnimation(curves.color);
+    WallClock wall(host::epochSeconds);
+    Timeline timeline;
+    host::setMicros(0);
+
+    int accepted = light.playAnimation(plainId) + light.crossfadeTo(plainId, 100) +
+                   light.playAt(plainId, wall, host::epochSeconds()) +
+                   timeline.addCue(0, light, plainId) +
+                   servo.playAnimation(colorId) + servo.crossfadeTo(colorId, 100) +
+                   servo.playAt(colorId, wall, host::epochSeconds()) +
+                   timeline.addCue(0, servo, colorId) +
+                   (servo.addAnimation(curves.color.getAnimation()) != NO_ANIMATION);
+    servo.playAnimation(curves.color.getAnimation());
+    accepted += servo.isPlaying();
+    runner.report("wrong kind accepted", accepted, "calls");
+    if (accepted != 0 || light.isPlaying()) {
+        runner.fail("kinds", "an animation of the wrong kind was played");
+    }
+    if (!light.playAnimation(colorId) || !servo.playAnimation(plainId)) {
+        runner.fail("kinds", "an animation of the right kind was refused");
+    }
+}
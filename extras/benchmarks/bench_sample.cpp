@@ -0,0 +1,72 @@
+// bench_sample.cpp
+// Filling a buffer with KeyframeAnimation::sampleRange() against
+// calling valueAt() once per sample
+
+#include "bench.h"
+#include "fixtures.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+
+const int KEYFRAME_COUNTS[] = {2, 16, 256, 4096};
+const int SAMPLE_COUNT = 4096;
+
+std::string label(const char* method, int keyframes) {
+    char text[64];
+    std::snprintf(text, sizeof(text), "method=%s kf=%d samples=%d", method, keyframes, SAMPLE_COUNT);
+    return text;
+}
+
+} // namespace
+
+YBN_BENCH(sampleRange) {
+    // Slightly past both ends so the clamped regions are exercised too
+    const float t0 = -50.0f;
+    const float dt = (fixtures::CURVE_DURATION_MS + 100.0f) / SAMPLE_COUNT;
+
+    for (int keyframes : KEYFRAME_COUNTS) {
+        KeyframeAnimation curve = fixtures::makeCurve("curve", keyframes);
+        std::vector<float> batch(SAMPLE_COUNT);
+        std::vector<float> single(SAMPLE_COUNT);
+        std::vector<int> rounded(SAMPLE_COUNT);
+
+        runner.measure(label("valueAt", keyframes), SAMPLE_COUNT, [&]() {
+            int segment = 0;
+            for (int i = 0; i < SAMPLE_COUNT; i++) {
+                single[i] = curve.valueAt(t0 + i * dt, segment);
+            }
+            bench::keep(single[SAMPLE_COUNT / 2]);
+        });
+        runner.measure(label("sampleRange", keyframes), SAMPLE_COUNT, [&]() {
+            curve.sampleRange(t0, dt, SAMPLE_COUNT, batch.data());
+            bench::keep(batch[SAMPLE_COUNT / 2]);
+        });
+        runner.measure(label("sampleRangeInt", keyframes), SAMPLE_COUNT, [&]() {
+            curve.sampleRange(t0, dt, SAMPLE_COUNT, rounded.data());
+            bench::keep(static_cast<long>(rounded[SAMPLE_COUNT / 2]));
+        });
+
+        // Both paths must produce the same curve
+        float maxError = 0;
+        for (int i = 0; i < SAMPLE_COUNT; i++) {
+            maxError = std::fmax(maxError, std::fabs(batch[i] - single[i]));
+        }
+        runner.report(label("sampleRange", keyframes), maxError, "max difference from valueAt");
+        if (maxError > 0) {
+            runner.fail(label("sampleRange", keyframes), "batch samples differ from valueAt()");
+        }
+        long maxIntError = 0;
+        for (int i = 0; i < SAMPLE_COUNT; i++) {
+            long error = std::labs(rounded[i] - std::lround(single[i]));
+            maxIntError = error > maxIntError ? error : maxIntError;
+        }
+        runner.report(label("sampleRangeInt", keyframes), maxIntError, "max difference from valueAt");
+        if (maxIntError > 1) {
+            runner.fail(label("sampleRangeInt", keyframes), "rounded batch samples differ from valueAt() by more than 1");
+        }
+    }
+}
@@ -0,0 +1,150 @@
+// bench_seek.cpp
+// seek() and seekNormalized(): a notifier that jumps to a time against
+// a fresh one that played there, straight after the jump and frame by
+// frame after it, in every mode and both engines, and the cost of a
+// jump as the keyframe count grows
+
+#include "bench.h"
+#include "engines.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+
+const unsigned long DURATION_MS = 10000;
+const unsigned long SEEK_TIMES[] = {0, 1234, 9999, 10000, 25678, 31000};
+const unsigned long FOLLOW_MS = 15000;
+
+// Same deterministic curve as fixtures::makeCurve(), for either engine
+template <typename Animation>
+Animation makeCurve(int keyframeCount) {
+    Animation animation("curve");
+    unsigned long seed = 12345;
+    for (int i = 0; i < keyframeCount; i++) {
+        seed = seed * 1103515245UL + 12345UL;
+        float value = static_cast<float>((seed >> 16) % 181);
+        animation.addKeyFrame(value, DURATION_MS * i / (keyframeCount - 1));
+    }
+    return animation;
+}
+
+// getValue() of a notifier that played from 0 and updated at ms
+template <typename Servo, typename Animation, typename Mode>
+int playedTo(const Animation& curve, Mode mode, unsigned long ms) {
+    Servo servo;
+    host::setMicros(0);
+    servo.playAnimation(curve, mode);
+    servo.update(ms);
+    return servo.getValue();
+}
+
+template <typename Servo, typename Animation, typename Mode>
+void checkSeek(bench::Runner& runner, const char* engine, Mode mode, const char* modeName) {
+    Animation curve = makeCurve<Animation>(64);
+    char label[64];
+    std::snprintf(label, sizeof(label), "engine=%s mode=%s", engine, modeName);
+    int largestError = 0;
+    for (unsigned long target : SEEK_TIMES) {
+        // The reference plays from 0; the other starts elsewhere, jumps
+        // to target at 500 ms, and must then match it frame for frame
+        Servo reference;
+        Servo seeker;
+        host::setMicros(0);
+        reference.playAnimation(curve, mode);
+        seeker.playAnimation(curve, mode);
+        seeker.update(300);
+        host::setMicros(500 * 1000);
+        if (!seeker.seek(target)) {
+            runner.fail(label, "seek() refused a playing animation");
+            return;
+        }
+        if (seeker.getValue() != playedTo<Servo>(curve, mode, target)) {
+            runner.fail(label, "the value straight after seek() differs from playing there");
+        }
+        for (unsigned long ms = 0; ms <= FOLLOW_MS; ms++) {
+            reference.update(target + ms);
+            seeker.update(500 + ms);
+            int error = std::abs(reference.getValue() - seeker.getValue());
+            largestError = error > largestError ? error : largestError;
+            if (reference.isCompleted() != seeker.isCompleted()) {
+                largestError = 1000;
+            }
+        }
+    }
+    runner.report(label, largestError, "max difference from playing there");
+    if (largestError > 0) {
+        runner.fail(label, "playback after seek() differs from playing to that time");
+    }
+
+    // The two ends of seekNormalized()
+    const float fractions[] = {0.0f, 1.0f};
+    for (float fraction : fractions) {
+        Servo seeker;
+        host::setMicros(0);
+        seeker.playAnimation(curve, mode);
+        host::setMicros(700 * 1000);
+        seeker.update();
+        seeker.seekNormalized(fraction);
+        unsigned long target = static_cast<unsigned long>(fraction * DURATION_MS);
+        bool matches = seeker.getValue() == playedTo<Servo>(curve, mode, target);
+        seeker.update(700 + 1234);
+        matches = matches && seeker.getValue() == playedTo<Servo>(curve, mode, target + 1234);
+        if (!matches) {
+            std::snprintf(label, sizeof(label), "engine=%s mode=%s fraction=%.0f", engine, modeName, fraction);
+            runner.fail(label, "seekNormalized() differs from playing to that fraction");
+        }
+    }
+}
+
+} // namespace
+
+YBN_BENCH(seekAccuracy) {
+    checkSeek<ybn_float::ServoNotifier, ybn_float::KeyframeAnimation>(runner, "float", ybn_float::PLAY_ONCE, "ONCE");
+    checkSeek<ybn_float::ServoNotifier, ybn_float::KeyframeAnimation>(runner, "float", ybn_float::PLAY_LOOP, "LOOP");
+    checkSeek<ybn_float::ServoNotifier, ybn_float::KeyframeAnimation>(runner, "float", ybn_float::PLAY_BOOMERANG, "BOOMERANG");
+    checkSeek<ybn_fixed::ServoNotifier, ybn_fixed::KeyframeAnimation>(runner, "fixed", ybn_fixed::PLAY_ONCE, "ONCE");
+    checkSeek<ybn_fixed::ServoNotifier, ybn_fixed::KeyframeAnimation>(runner, "fixed", ybn_fixed::PLAY_LOOP, "LOOP");
+    checkSeek<ybn_fixed::ServoNotifier, ybn_fixed::KeyframeAnimation>(runner, "fixed", ybn_fixed::PLAY_BOOMERANG, "BOOMERANG");
+
+    // A fraction of the way through, and resuming after a seek while paused
+    ybn_float::KeyframeAnimation curve = makeCurve<ybn_float::KeyframeAnimation>(64);
+    ybn_float::ServoNotifier servo;
+    host::setMicros(0);
+    servo.playAnimation(curve, ybn_float::PLAY_ONCE);
+    servo.seekNormalized(0.25f);
+    int segment = 0;
+    if (servo.getValue() != static_cast<int>(std::lround(curve.valueAt(DURATION_MS / 4, segment)))) {
+        runner.fail("seekNormalized", "value is not a quarter of the way through");
+    }
+    servo.pause();
+    host::setMicros(4000 * 1000);
+    servo.seek(6000);
+    host::setMicros(9000 * 1000);
+    servo.resume();
+    servo.update(9000 + 250);
+    segment = 0;
+    if (servo.getValue() != static_cast<int>(std::lround(curve.valueAt(6250, segment)))) {
+        runner.fail("seekWhilePaused", "resume() does not continue from the seek");
+    }
+}
+
+YBN_BENCH(seekCost) {
+    // Random jumps: a binary search for the segment, whatever the count
+    const int KEYFRAME_COUNTS[] = {16, 256, 4096};
+    for (int keyframes : KEYFRAME_COUNTS) {
+        ybn_float::KeyframeAnimation curve = makeCurve<ybn_float::KeyframeAnimation>(keyframes);
+        ybn_float::ServoNotifier servo;
+        host::setMicros(0);
+        servo.playAnimation(curve, ybn_float::PLAY_LOOP);
+        unsigned long seed = 99;
+        char label[64];
+        std::snprintf(label, sizeof(label), "kf=%d", keyframes);
+        runner.measure(label, 1, [&]() {
+            seed = seed * 1103515245UL + 12345UL;
+            servo.seek((seed >> 8) % (3 * DURATION_MS));
+            bench::keep(static_cast<long>(servo.getValue()));
+        });
+    }
+}
@@ -0,0 +1,115 @@
+// bench_simplify.cpp
+// KeyframeAnimation::simplify() on densely sampled motion: keyframes
+// removed, the reported error against an independent check, curved
+// segments left as they were, and the lookup cost before and after
+
+#include "bench.h"
+#include "fixtures.h"
+
+#include <cmath>
+#include <cstdio>
+#include <string>
+
+namespace {
+
+const int CAPTURE_COUNT = 10000;   // 10 s captured at 1 kHz
+const float TOLERANCES[] = {0.25f, 1.0f, 4.0f};
+
+// Smooth motion plus sensor noise, one keyframe per ms
+KeyframeAnimation makeCapture() {
+    KeyframeAnimation capture("capture");
+    capture.reserve(CAPTURE_COUNT);
+    unsigned long seed = 99;
+    for (int i = 0; i < CAPTURE_COUNT; i++) {
+        seed = seed * 1103515245UL + 12345UL;
+        float noise = ((seed >> 16) % 1000) / 1000.0f - 0.5f;
+        float value = 90 + 60 * std::sin(i * 0.0011f) + 20 * std::sin(i * 0.0047f) + noise * 0.4f;
+        capture.addKeyFrame(value, i);
+    }
+    return capture;
+}
+
+std::string label(float tolerance) {
+    char text[64];
+    std::snprintf(text, sizeof(text), "tolerance=%.2f kf=%d", tolerance, CAPTURE_COUNT);
+    return text;
+}
+
+} // namespace
+
+YBN_BENCH(simplifyCapture) {
+    KeyframeAnimation capture = makeCapture();
+    int segment = 0;
+    float time = 0;
+    runner.measure("original", 1, [&]() {
+        bench::keep(capture.valueAt(time, segment));
+        time = time >= CAPTURE_COUNT ? 0 : time + 0.37f;
+    });
+
+    for (float tolerance : TOLERANCES) {
+        KeyframeAnimation simplified = capture;
+        float reportedError = 0;
+        int removed = simplified.simplify(tolerance, &reportedError);
+        runner.report(label(tolerance), removed, "keyframes removed");
+        runner.report(label(tolerance), reportedError, "max error reported");
+
+        // Check against the original on a sweep finer than the keyframes
+        float measuredError = 0;
+        int originalSegment = 0;
+        int simplifiedSegment = 0;
+        for (float t = 0; t < CAPTURE_COUNT; t += 0.25f) {
+            measuredError = std::fmax(measuredError, std::fabs(capture.valueAt(t, originalSegment) -
+                                                               simplified.valueAt(t, simplifiedSegment)));
+        }
+        if (measuredError > tolerance + 0.001f || std::fabs(measuredError - reportedError) > 0.001f) {
+            runner.fail(label(tolerance), "error over tolerance or misreported");
+        }
+        if (removed != CAPTURE_COUNT - simplified.getKeyframeCount()) {
+            runner.fail(label(tolerance), "removed count does not match");
+        }
+
+        segment = 0;
+        time = 0;
+        runner.measure(label(tolerance), 1, [&]() {
+            bench::keep(simplified.valueAt(time, segment));
+            time = time >= CAPTURE_COUNT ? 0 : time + 0.37f;
+        });
+    }
+
+    runner.measure("simplify tolerance=1.00", CAPTURE_COUNT, [&]() {
+        KeyframeAnimation copy = capture;
+        bench::keep(static_cast<long>(copy.simplify(1.0f)));
+    });
+}
+
+YBN_BENCH(simplifyCurves) {
+    // Linear runs either side of Catmull-Rom and eased segments: the
+    // curves must play exactly as before, whatever is removed around them
+    KeyframeAnimation curves("curves");
+    for (int i = 0; i <= 40; i++) {
+        float value = i < 10 || i > 30 ? i * 2.0f : 90 + 40 * std::sin(i * 0.7f);
+        curves.addKeyFrame(value, i * 100UL);
+    }
+    curves.setKeyFrameEasing(15, CATMULL_ROM);
+    curves.setKeyFrameEasing(16, CATMULL_ROM);
+    curves.setKeyFrameEasing(25, CATMULL_ROM);
+    curves.setKeyFrameEasing(20, EASE_IN_OUT);
+
+    KeyframeAnimation simplified = curves;
+    int removed = simplified.simplify(1000.0f);
+    float curveError = 0;
+    int originalSegment = 0;
+    int simplifiedSegment = 0;
+    const int eased[] = {15, 16, 20, 25};
+    for (int keyframe : eased) {
+        for (float t = (keyframe - 1) * 100.0f; t <= keyframe * 100.0f; t += 0.5f) {
+            curveError = std::fmax(curveError, std::fabs(curves.valueAt(t, originalSegment) -
+                                                         simplified.valueAt(t, simplifiedSegment)));
+        }
+    }
+    runner.report("tolerance=1000 kf=41", removed, "keyframes removed");
+    runner.report("tolerance=1000 kf=41", curveError, "max curve change");
+    if (curveError > 0.001f || removed == 0) {
+        runner.fail("tolerance=1000 kf=41", "simplify() changed a curved segment");
+    }
+}
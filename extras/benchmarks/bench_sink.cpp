@@ -0,0 +1,103 @@
+// bench_sink.cpp
+// OutputSink: channels of one device flushed as a single transaction
+// per frame, against one bus transaction per changed channel
+
+#include "bench.h"
+#include "fixtures.h"
+#include "MockOutputSink.h"
+
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+const int CHANNEL_COUNTS[] = {16, 32};
+const unsigned long RUN_MS = 10000;
+
+} // namespace
+
+YBN_BENCH(sinkTransactions) {
+    for (int channels : CHANNEL_COUNTS) {
+        // 12-bit PWM fades, one keyframe curve per channel
+        std::vector<KeyframeAnimation> fades;
+        for (int i = 0; i < channels; i++) {
+            KeyframeAnimation fade("fade");
+            fade.addKeyFrame(0, 0);
+            fade.addKeyFrame(4095, 1000 + 250 * i);
+            fade.addKeyFrame(0, RUN_MS);
+            fades.push_back(fade);
+        }
+
+        MockOutputSink sink(channels);
+        std::vector<SinkNotifier> notifiers;
+        notifiers.reserve(channels);
+        NotifierGroup group;
+        host::setMicros(0);
+        for (int i = 0; i < channels; i++) {
+            notifiers.push_back(SinkNotifier(sink, i));
+        }
+        for (int i = 0; i < channels; i++) {
+            group.add(notifiers[i]);
+            notifiers[i].playAnimation(fades[i], PLAY_ONCE);
+        }
+
+        long frames = 0;
+        long changedChannels = 0;
+        bool mismatch = false;
+        std::vector<int> previous(channels, 0);
+        for (unsigned long ms = 0; ms <= RUN_MS; ms++) {
+            group.update(ms);
+            frames++;
+            for (int i = 0; i < channels; i++) {
+                int value = notifiers[i].getValue();
+                changedChannels += value != previous[i];
+                previous[i] = value;
+                if (sink.hardwareLevel(i) != value) {
+                    mismatch = true;
+                }
+            }
+        }
+
+        char label[64];
+        std::snprintf(label, sizeof(label), "channels=%d", channels);
+        runner.report(label, frames, "frames");
+        runner.report(label, changedChannels, "transactions unbatched");
+        runner.report(label, sink.getTransactionCount(), "transactions batched");
+        runner.report(label, sink.getChannelWrites(), "channels sent");
+        if (mismatch) {
+            runner.fail(label, "device does not hold the notifier levels");
+        }
+        if (static_cast<long>(sink.getTransactionCount()) > frames) {
+            runner.fail(label, "more than one transaction per frame");
+        }
+
+        // Overshooting the 16-bit channel holds it full on, not wrapped
+        KeyframeAnimation overshoot("overshoot");
+        overshoot.addKeyFrame(65000, 0);
+        overshoot.addKeyFrame(70000, 100);
+        overshoot.addKeyFrame(-5000, 200);
+        host::setMicros(RUN_MS * 1000);
+        notifiers[0].playAnimation(overshoot, PLAY_ONCE);
+        bool wrapped = false;
+        bool overshot = false;
+        for (unsigned long ms = RUN_MS; ms <= RUN_MS + 200; ms++) {
+            group.update(ms);
+            int value = notifiers[0].getValue();
+            int expected = value < 0 ? 0 : (value > 65535 ? 65535 : value);
+            wrapped = wrapped || sink.hardwareLevel(0) != expected;
+            overshot = overshot || value > 65535;
+        }
+        if (wrapped || !overshot) {
+            runner.fail(label, "levels outside 0..65535 are not clamped");
+        }
+
+        // Update and flush cost for the whole group, fades looping
+        for (int i = 0; i < channels; i++) {
+            notifiers[i].playAnimation(fades[i], PLAY_LOOP);
+        }
+        unsigned long now = 0;
+        runner.measure(label, channels, [&]() {
+            group.update(++now);
+        });
+    }
+}
@@ -0,0 +1,126 @@
+// bench_soak.cpp
+// 24 hours of looping and boomerang playback on jittery frames, with
+// stalls that span several passes, in both engines. Every update is
+// checked against the value and the time into the pass computed
+// directly from the clock, so any drift shows up as a growing difference
+
+#include "bench.h"
+#include "engines.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+
+const unsigned long SOAK_MS = 24UL * 60 * 60 * 1000;
+const float SPEED = 1.3f;
+const int NOTIFIER_COUNT = 3;
+const float VALUES[] = {90, 150, 30, 90};
+const unsigned long TIMES[] = {0, 1200, 2500, 3700};
+
+template <typename Animation>
+Animation makeLoop() {
+    Animation animation("soak");
+    for (int i = 0; i < 4; i++) {
+        animation.addKeyFrame(VALUES[i], TIMES[i]);
+    }
+    return animation;
+}
+
+// Rounded value at a clock time (us), folded straight from the elapsed time
+int idealValue(const ybn_float::KeyframeAnimation& animation, bool boomerang, unsigned long us) {
+    double duration = TIMES[3];
+    double position = std::fmod(us / 1000.0 * SPEED, boomerang ? 2 * duration : duration);
+    if (position >= duration) {
+        position = 2 * duration - position;
+    }
+    int segment = 0;
+    return static_cast<int>(std::lround(animation.valueAt(static_cast<float>(position), segment)));
+}
+
+// Phase error in whole ms: getElapsedTime() against the wall time into
+// the pass, wrapping around the pass. Only checked a quarter ms or more
+// from a ms boundary, so rounding cannot change it and any error is
+// drift. 0 when too close to a boundary
+long phaseError(unsigned long elapsedMs, unsigned long us) {
+    double pass = TIMES[3] / static_cast<double>(SPEED);
+    double ideal = std::fmod(us / 1000.0, pass);
+    double fraction = ideal - std::floor(ideal);
+    if (fraction < 0.25 || fraction > 0.75) {
+        return 0;
+    }
+    long error = std::labs(static_cast<long>(elapsedMs) - static_cast<long>(ideal));
+    long around = static_cast<long>(pass + 0.5) - error;
+    return error < around ? error : around;
+}
+
+template <typename Servo, typename Animation, typename Clock, typename Mode>
+void soakEngine(bench::Runner& runner, const char* engine, const Clock& clock, Mode mode, bool boomerang) {
+    ybn_float::KeyframeAnimation reference = makeLoop<ybn_float::KeyframeAnimation>();
+    Animation animation = makeLoop<Animation>();
+    std::vector<Servo> servos(NOTIFIER_COUNT);
+    host::setMicros(0);
+    for (Servo& servo : servos) {
+        servo.setTimeSource(clock);
+        servo.setGlobalSpeed(SPEED);
+        servo.playAnimation(animation, mode);
+    }
+
+    // Each servo runs on its own jittery schedule: 0-40 ms frames, and
+    // now and then a stall longer than three passes
+    int largestError = 0;
+    long largestPhaseError = 0;
+    long updates = 0;
+    unsigned long seed = 2024;
+    for (int i = 0; i < NOTIFIER_COUNT; i++) {
+        unsigned long now = 0;
+        long frame = 0;
+        while (now < SOAK_MS * 1000UL) {
+            seed = seed * 1103515245UL + 12345UL;
+            now += ++frame % 5000 == 0 ? 9100000UL : (seed >> 8) % 40000;
+            servos[i].update(now);
+            updates++;
+            int error = std::abs(servos[i].getValue() - idealValue(reference, boomerang, now));
+            largestError = error > largestError ? error : largestError;
+            long phase = phaseError(servos[i].getElapsedTime(now), now);
+            largestPhaseError = phase > largestPhaseError ? phase : largestPhaseError;
+        }
+    }
+
+    // Whatever their schedules, they still agree
+    unsigned long end = SOAK_MS * 1000UL + 12345678UL;   // After every schedule
+    int spread = 0;
+    for (Servo& servo : servos) {
+        servo.update(end);
+        spread = std::abs(servo.getValue() - servos[0].getValue()) > spread
+            ? std::abs(servo.getValue() - servos[0].getValue()) : spread;
+    }
+
+    char label[64];
+    std::snprintf(label, sizeof(label), "engine=%s mode=%s", engine, boomerang ? "BOOMERANG" : "LOOP");
+    runner.report(label, updates, "updates over 24 h");
+    runner.report(label, largestError, "max difference from the clock");
+    runner.report(label, spread, "spread between servos");
+    runner.report(label, largestPhaseError, "ms max phase error");
+    if (largestError > 1 || spread > 1) {
+        runner.fail(label, "playback drifted from the clock");
+    }
+    if (largestPhaseError != 0) {
+        runner.fail(label, "the time into the pass drifted from the clock");
+    }
+}
+
+} // namespace
+
+YBN_BENCH(loopSoak) {
+    soakEngine<ybn_float::ServoNotifier, ybn_float::KeyframeAnimation>(
+        runner, "float", ybn_float::MICROS_CLOCK, ybn_float::PLAY_LOOP, false);
+    soakEngine<ybn_float::ServoNotifier, ybn_float::KeyframeAnimation>(
+        runner, "float", ybn_float::MICROS_CLOCK, ybn_float::PLAY_BOOMERANG, true);
+    soakEngine<ybn_fixed::ServoNotifier, ybn_fixed::KeyframeAnimation>(
+        runner, "fixed", ybn_fixed::MICROS_CLOCK, ybn_fixed::PLAY_LOOP, false);
+    soakEngine<ybn_fixed::ServoNotifier, ybn_fixed::KeyframeAnimation>(
+        runner, "fixed", ybn_fixed::MICROS_CLOCK, ybn_fixed::PLAY_BOOMERANG, true);
+}
@@ -0,0 +1,78 @@
+// bench_table.cpp
+// Keyframes played in place from a constant table against the same
+// keyframes copied into a KeyframeAnimation's RAM arrays
+
+#include "bench.h"
+#include "fixtures.h"
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+const int KEYFRAME_COUNTS[] = {16, 256, 4096};
+
+// The table divides where the RAM arrays multiply by a stored slope, so
+// the two may differ in the last bit of a float, never by more
+const float ROUNDING = 1e-3f;
+
+// A table declared the way a sketch would, checked at compile time
+constexpr Keyframe nodFrames[] PROGMEM = {{90, 0}, {120, 250}, {60, 750}, {90, 1000}};
+
+std::vector<Keyframe> toTable(const KeyframeAnimation& curve) {
+    std::vector<Keyframe> table;
+    for (int i = 0; i < curve.getKeyframeCount(); i++) {
+        Keyframe keyframe = {curve.getKeyFrameValue(i), curve.getKeyFrameTime(i)};
+        table.push_back(keyframe);
+    }
+    return table;
+}
+
+std::string label(const char* storage, int keyframes) {
+    char text[64];
+    std::snprintf(text, sizeof(text), "storage=%s kf=%d", storage, keyframes);
+    return text;
+}
+
+} // namespace
+
+YBN_BENCH(tableValueAt) {
+    for (int keyframes : KEYFRAME_COUNTS) {
+        KeyframeAnimation ram = fixtures::makeCurve("curve", keyframes);
+        std::vector<Keyframe> frames = toTable(ram);
+        KeyframeAnimation table("curve", frames.data(), frames.size());
+
+        // Sequential sweep in 1 ms steps, as a tight loop() would play it
+        const KeyframeAnimation* animations[] = {&ram, &table};
+        const char* storage[] = {"ram", "table"};
+        for (int a = 0; a < 2; a++) {
+            const KeyframeAnimation& animation = *animations[a];
+            int segment = 0;
+            float time = 0;
+            runner.measure(label(storage[a], keyframes), 1, [&]() {
+                bench::keep(animation.valueAt(time, segment));
+                time += 1.0f;
+                if (time > fixtures::CURVE_DURATION_MS) {
+                    time = 0;
+                }
+            });
+        }
+
+        // Both must produce the same curve
+        float maxError = 0;
+        int ramSegment = 0;
+        int tableSegment = 0;
+        for (float time = 0; time <= fixtures::CURVE_DURATION_MS; time += 0.25f) {
+            float error = std::fabs(ram.valueAt(time, ramSegment) - table.valueAt(time, tableSegment));
+            maxError = std::fmax(maxError, error);
+        }
+        runner.report(label("table", keyframes), maxError, "max difference from ram");
+        if (maxError > ROUNDING) {
+            runner.fail(label("table", keyframes), "the table plays a different curve from the ram keyframes");
+        }
+    }
+
+    KeyframeAnimation nod("nod", nodFrames);
+    bench::keep(static_cast<long>(nod.getDuration()));
+}
@@ -0,0 +1,345 @@
+// bench_timeline.cpp
+// Timeline cue sheets: a long show on jittery frames with stalls,
+// fired by a Timeline in a NotifierGroup against cues fired exactly on
+// time, in both engines; firing order across restarts of a looped show
+// and over a five-hour show on micros(); and the per-frame cost of the
+// cue cursor against scanning every cue
+
+#include "bench.h"
+#include "engines.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+
+const int SERVO_COUNT = 4;
+const int CUE_COUNT = 2000;
+const unsigned long BLEND_MS = 300;
+
+struct CueSpec {
+    unsigned long time;   // ms
+    int servo;
+    int animation;
+    int mode;
+    unsigned long blendTime;
+};
+
+// Curves of different lengths, so cues land mid-pass
+template <typename Animation>
+Animation makeCurve(const char* name, int keyframeCount, unsigned long duration, unsigned long seed) {
+    Animation animation(name);
+    for (int i = 0; i < keyframeCount; i++) {
+        seed = seed * 1103515245UL + 12345UL;
+        float value = static_cast<float>((seed >> 16) % 181);
+        animation.addKeyFrame(value, duration * i / (keyframeCount - 1));
+    }
+    return animation;
+}
+
+std::vector<CueSpec> makeCues() {
+    std::vector<CueSpec> cues;
+    unsigned long seed = 777;
+    unsigned long time = 0;
+    for (int i = 0; i < CUE_COUNT; i++) {
+        seed = seed * 1103515245UL + 12345UL;
+        time += (seed >> 16) % 4 == 0 ? 0 : 50 + (seed >> 8) % 550;   // Some share a time
+        CueSpec cue = {time, static_cast<int>((seed >> 4) % SERVO_COUNT), static_cast<int>((seed >> 12) % 3),
+                       static_cast<int>((seed >> 20) % 3), i % 3 == 2 ? BLEND_MS : 0};
+        cues.push_back(cue);
+    }
+    return cues;
+}
+
+// Frame times in us: 0.5 to 8 ms apart, with a 1.5 s stall now and then
+std::vector<unsigned long> makeFrames(unsigned long endMs) {
+    std::vector<unsigned long> frames;
+    unsigned long seed = 4242;
+    unsigned long us = 0;
+    while (us <= endMs * 1000) {
+        frames.push_back(us);
+        seed = seed * 1103515245UL + 12345UL;
+        us += frames.size() % 97 == 0 ? 1500000 : 500 + (seed >> 8) % 7500;
+    }
+    return frames;
+}
+
+template <typename Servo, typename Mode>
+void fireCue(std::vector<Servo>& servos, const std::vector<int>& ids, const CueSpec& cue, Mode mode) {
+    if (cue.blendTime == 0) {
+        servos[cue.servo].playAnimation(ids[cue.animation], mode);
+    } else {
+        servos[cue.servo].crossfadeTo(ids[cue.animation], cue.blendTime, mode);
+    }
+}
+
+template <typename Group, typename Servo, typename Timeline, typename Animation, typename Mode, typename Clock>
+void checkEngine(bench::Runner& runner, const char* engine, const Clock& micros) {
+    std::vector<Animation> animations;
+    animations.push_back(makeCurve<Animation>("timelineA", 16, 1700, 1));
+    animations.push_back(makeCurve<Animation>("timelineB", 40, 4300, 2));
+    animations.push_back(makeCurve<Animation>("timelineC", 5, 900, 3));
+    std::vector<CueSpec> cues = makeCues();
+    std::vector<unsigned long> frames = makeFrames(cues.back().time + 5000);
+
+    // Each run plays the show on its own servos: 0 fires every cue
+    // exactly on time, 1 through a Timeline, 2 when a frame sees it due
+    std::vector<std::vector<int>> values[3];
+    bool finished = false;
+    for (int run = 0; run < 3; run++) {
+        Group group;
+        group.setTimeSource(micros);
+        std::vector<Servo> servos(SERVO_COUNT);
+        std::vector<int> ids;
+        for (int i = 0; i < SERVO_COUNT; i++) {
+            group.add(servos[i]);
+        }
+        for (const Animation& animation : animations) {
+            ids.push_back(servos[0].addAnimation(animation));
+        }
+        Timeline timeline;
+        if (run == 1) {
+            timeline.reserve(CUE_COUNT);
+            for (const CueSpec& cue : cues) {
+                timeline.addCue(cue.time, servos[cue.servo], ids[cue.animation],
+                                static_cast<Mode>(cue.mode), cue.blendTime);
+            }
+            group.setTimeline(&timeline);
+            host::setMicros(0);
+            timeline.start();
+        }
+
+        size_t next = 0;
+        for (unsigned long frame : frames) {
+            while (run != 1 && next < cues.size() && cues[next].time * 1000 <= frame) {
+                host::setMicros(run == 0 ? cues[next].time * 1000 : frame);
+                fireCue(servos, ids, cues[next], static_cast<Mode>(cues[next].mode));
+                next++;
+            }
+            host::setMicros(frame);
+            group.update(frame);
+            std::vector<int> frameValues(SERVO_COUNT);
+            for (int i = 0; i < SERVO_COUNT; i++) {
+                frameValues[i] = servos[i].getValue();
+            }
+            values[run].push_back(frameValues);
+        }
+        if (run == 1) {
+            finished = timeline.isFinished() && timeline.getNextCue() == CUE_COUNT;
+        }
+    }
+
+    const char* names[] = {"", "timeline", "polled"};
+    for (int run = 1; run < 3; run++) {
+        int largestError = 0;
+        for (size_t f = 0; f < frames.size(); f++) {
+            for (int i = 0; i < SERVO_COUNT; i++) {
+                int error = std::abs(values[run][f][i] - values[0][f][i]);
+                largestError = error > largestError ? error : largestError;
+            }
+        }
+        char label[64];
+        std::snprintf(label, sizeof(label), "engine=%s cues=%d fire=%s", engine, CUE_COUNT, names[run]);
+        runner.report(label, largestError, "max difference from on time");
+        if (run == 1 && largestError > 0) {
+            runner.fail(label, "late cues did not play as if fired on time");
+        }
+    }
+    runner.report(engine, frames.size(), "frames");
+    if (!finished) {
+        runner.fail(engine, "the timeline missed cues");
+    }
+}
+
+} // namespace
+
+YBN_BENCH(timelineCues) {
+    checkEngine<ybn_float::NotifierGroup, ybn_float::ServoNotifier, ybn_float::Timeline,
+                ybn_float::KeyframeAnimation, ybn_float::PlayMode>(runner, "float", ybn_float::MICROS_CLOCK);
+    checkEngine<ybn_fixed::NotifierGroup, ybn_fixed::ServoNotifier, ybn_fixed::Timeline,
+                ybn_fixed::KeyframeAnimation, ybn_fixed::PlayMode>(runner, "fixed", ybn_fixed::MICROS_CLOCK);
+}
+
+YBN_BENCH(timelineOrder) {
+    // Cues added out of order fire by time, equal times in the order added
+    ybn_float::KeyframeAnimation first = makeCurve<ybn_float::KeyframeAnimation>("orderFirst", 4, 1000, 5);
+    ybn_float::KeyframeAnimation second = makeCurve<ybn_float::KeyframeAnimation>("orderSecond", 4, 1000, 6);
+    ybn_float::ServoNotifier servo;
+    ybn_float::AnimationId firstId = servo.addAnimation(first);
+    ybn_float::AnimationId secondId = servo.addAnimation(second);
+    ybn_float::Timeline timeline;
+    const unsigned long times[] = {500, 100, 300, 100, 0};
+    for (int i = 0; i < 5; i++) {
+        timeline.addCue(times[i], servo, i == 3 ? secondId : firstId);
+    }
+    if (timeline.addCue(50, servo, "missing")) {
+        runner.fail("unknown", "a cue for an unknown animation was accepted");
+    }
+    for (int i = 1; i < timeline.getCueCount(); i++) {
+        if (timeline.getCueTime(i) < timeline.getCueTime(i - 1)) {
+            runner.fail("sorted", "cues are not in time order");
+        }
+    }
+
+    host::setMicros(0);
+    timeline.start(0);
+    host::setMicros(300 * 1000);
+    int fired = timeline.update(300);
+    if (fired != 4 || servo.getCurrentAnimationName() != "orderFirst" || timeline.timeToNextCue(300) != 200) {
+        runner.fail("due", "a late update must fire every cue due, in order");
+    }
+    host::setMicros(100 * 1000);
+    timeline.start(0);
+    timeline.update(100);
+    if (servo.getCurrentAnimationName() != "orderSecond") {
+        runner.fail("equalTimes", "cues at the same time must fire in the order added");
+    }
+
+    // Behind the cursor: waits for the next start()
+    timeline.addCue(50, servo, firstId);
+    host::setMicros(600 * 1000);
+    if (timeline.update(600) != 2 || !timeline.isFinished()) {
+        runner.fail("behind", "a cue added behind the position must not fire");
+    }
+    runner.report("cues=6", timeline.getCueCount(), "cues");
+
+    // A show restarted three times on 1 ms frames, each cue on its own
+    // servo looping a short curve: every frame fires exactly the cues
+    // that came due, so none early, late or twice as the curves wrap
+    const int COUNT = 8;
+    const unsigned long showTimes[COUNT] = {601, 120, 0, 990, 250, 120, 1500, 600};
+    ybn_float::KeyframeAnimation shortCurve = makeCurve<ybn_float::KeyframeAnimation>("orderShort", 3, 70, 8);
+    std::vector<ybn_float::ServoNotifier> servos(COUNT);
+    ybn_float::Timeline show;
+    for (int i = 0; i < COUNT; i++) {
+        show.addCue(showTimes[i], servos[i], servos[i].addAnimation(shortCurve), ybn_float::PLAY_LOOP);
+    }
+    long firedInAll = 0;
+    bool inOrder = true;
+    for (int pass = 0; pass < 3; pass++) {
+        unsigned long begin = 5000 + pass * 2000;
+        for (auto& servo : servos) {
+            servo.stop();
+        }
+        host::setMicros(begin * 1000);
+        show.start(begin);
+        for (unsigned long ms = 0; ms <= 1800; ms++) {
+            host::setMicros((begin + ms) * 1000);
+            int fired = show.update(begin + ms);
+            int due = 0;
+            for (int i = 0; i < COUNT; i++) {
+                servos[i].update(begin + ms);
+                due += showTimes[i] == ms;
+                inOrder = inOrder && servos[i].isPlaying() == (showTimes[i] <= ms);
+            }
+            inOrder = inOrder && fired == due;
+            firedInAll += fired;
+        }
+    }
+    runner.report("restarts=3", firedInAll, "cues fired");
+    if (!inOrder || firedInAll != 3 * COUNT) {
+        runner.fail("restarts=3", "cues must fire when due, once each time the show is started");
+    }
+
+    // Five hours on micros(), starting just before the clock wraps
+    ybn_float::ServoNotifier late;
+    ybn_float::Timeline longShow;
+    longShow.setTimeSource(ybn_float::MICROS_CLOCK);
+    const unsigned long FIVE_HOURS_MS = 5UL * 60 * 60 * 1000;
+    longShow.addCue(FIVE_HOURS_MS, late, late.addAnimation(shortCurve));
+    longShow.addCue(FIVE_HOURS_MS + 1, late, firstId);
+    unsigned long begin = static_cast<unsigned long>(-2000000000L);
+    longShow.start(begin);
+    int early = 0;
+    for (unsigned long ms = 0; ms < FIVE_HOURS_MS; ms += 10000) {
+        early += longShow.update(begin + ms * 1000);
+    }
+    unsigned long wait = longShow.timeToNextCue(begin + (FIVE_HOURS_MS - 1) * 1000);
+    int due = longShow.update(begin + FIVE_HOURS_MS * 1000);
+    int next = longShow.update(begin + FIVE_HOURS_MS * 1000 + 999);
+    int last = longShow.update(begin + FIVE_HOURS_MS * 1000 + 1000);
+    runner.report("hours=5 clock=micros", wait, "ticks waited for the cue");
+    if (early != 0 || wait != 1000 || due != 1 || next != 0 || last != 1 || !longShow.isFinished()) {
+        runner.fail("hours=5 clock=micros", "cues past the clock's wrap fired at the wrong time");
+    }
+
+    // A blended cue after a PLAY_ONCE animation has finished fades from
+    // where it came to rest
+    ybn_float::KeyframeAnimation rise("cueRise");
+    rise.addKeyFrame(0, 0);
+    rise.addKeyFrame(90, 1000);
+    ybn_float::KeyframeAnimation high("cueHigh");
+    high.addKeyFrame(180, 0);
+    high.addKeyFrame(180, 1000);
+    ybn_float::ServoNotifier rested;
+    ybn_float::Timeline blended;
+    blended.addCue(0, rested, rested.addAnimation(rise));
+    blended.addCue(2000, rested, rested.addAnimation(high), ybn_float::PLAY_LOOP, 1000);
+    host::setMicros(0);
+    blended.start(0);
+    int largestError = 0;
+    for (unsigned long ms = 0; ms <= 4000; ms += 10) {
+        host::setMicros(ms * 1000);
+        blended.update(ms);
+        rested.update(ms);
+        if (ms < 2000) {
+            continue;
+        }
+        float weight = ms < 3000 ? (ms - 2000) / 1000.0f : 1;
+        int error = std::abs(rested.getValue() - static_cast<int>(std::lround(90 + 90 * weight)));
+        largestError = error > largestError ? error : largestError;
+    }
+    runner.report("blend after ONCE", largestError, "max difference from the blend");
+    if (largestError > 1 || rested.isBlendingAnimations() || rested.getCurrentAnimationName() != "cueHigh") {
+        runner.fail("blend after ONCE", "a blended cue after a finished animation did not play");
+    }
+}
+
+YBN_BENCH(timelineCost) {
+    // Per-frame cost of a 10000-cue show at 1 ms frames: the cursor in
+    // update() against checking every cue each frame
+    const int COUNT = 10000;
+    ybn_float::KeyframeAnimation curve = makeCurve<ybn_float::KeyframeAnimation>("cost", 16, 1700, 7);
+    ybn_float::ServoNotifier servo;
+    ybn_float::AnimationId id = servo.addAnimation(curve);
+    ybn_float::Timeline timeline;
+    timeline.reserve(COUNT);
+    std::vector<unsigned long> times;
+    for (int i = 0; i < COUNT; i++) {
+        times.push_back(100UL * i);
+        timeline.addCue(times.back(), servo, id, ybn_float::PLAY_LOOP);
+    }
+    unsigned long end = times.back() + 100;
+
+    unsigned long now = 0;
+    host::setMicros(0);
+    timeline.start(0);
+    runner.measure("cues=10000 fire=cursor", 1, [&]() {
+        now++;
+        if (now >= end) {
+            now = 0;
+            timeline.start(0);
+        }
+        host::setMicros(now * 1000);
+        bench::keep(static_cast<long>(timeline.update(now)));
+    });
+
+    std::vector<bool> fired(COUNT, false);
+    now = 0;
+    runner.measure("cues=10000 fire=scan", 1, [&]() {
+        now++;
+        if (now >= end) {
+            now = 0;
+            fired.assign(COUNT, false);
+        }
+        host::setMicros(now * 1000);
+        for (int i = 0; i < COUNT; i++) {
+            if (!fired[i] && times[i] <= now) {
+                fired[i] = true;
+                servo.playAnimation(id, ybn_float::PLAY_LOOP);
+            }
+        }
+    });
+}
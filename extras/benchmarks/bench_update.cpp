@@ -0,0 +1,104 @@
+// bench_update.cpp
+// Per-frame cost of ServoNotifier::update() and LEDNotifier::update()
+// across keyframe counts, playback modes, frame steps and notifier counts
+
+#include "bench.h"
+#include "fixtures.h"
+
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+const int KEYFRAME_COUNTS[] = {2, 16, 256, 4096};
+const PlayMode MODES[] = {PLAY_ONCE, PLAY_LOOP, PLAY_BOOMERANG};
+
+// 1 ms is a tight loop(); 97 ms is a slow frame that skips keyframes
+const unsigned long FRAME_STEPS_MS[] = {1, 97};
+
+std::string label(int keyframes, PlayMode mode, unsigned long stepMs, int notifiers) {
+    char text[96];
+    std::snprintf(text, sizeof(text), "kf=%d mode=%s step=%lums n=%d",
+                  keyframes, fixtures::modeName(mode), stepMs, notifiers);
+    return text;
+}
+
+template <typename NotifierType>
+void runUpdates(bench::Runner& runner, std::vector<NotifierType>& notifiers,
+                int keyframes, PlayMode mode, unsigned long stepMs) {
+    KeyframeAnimation curve = fixtures::makeCurve("curve", keyframes);
+    host::setMicros(0);
+    for (size_t i = 0; i < notifiers.size(); i++) {
+        notifiers[i].addAnimation(curve);
+        notifiers[i].playAnimation(curve, mode);
+    }
+
+    runner.measure(label(keyframes, mode, stepMs, notifiers.size()), notifiers.size(), [&]() {
+        host::advanceMillis(stepMs);
+        for (size_t i = 0; i < notifiers.size(); i++) {
+            notifiers[i].update();
+        }
+        // Restart ONCE animations so every frame does real work
+        if (notifiers[0].isCompleted()) {
+            for (size_t i = 0; i < notifiers.size(); i++) {
+                notifiers[i].playAnimation("curve", mode);
+            }
+        }
+        bench::keep(static_cast<long>(notifiers[0].getValue()));
+    });
+}
+
+} // namespace
+
+YBN_BENCH(servoUpdate) {
+    for (int keyframes : KEYFRAME_COUNTS) {
+        for (PlayMode mode : MODES) {
+            for (unsigned long stepMs : FRAME_STEPS_MS) {
+                std::vector<ServoNotifier> notifiers(1);
+                runUpdates(runner, notifiers, keyframes, mode, stepMs);
+            }
+        }
+    }
+}
+
+YBN_BENCH(ledUpdate) {
+    for (int keyframes : KEYFRAME_COUNTS) {
+        for (PlayMode mode : MODES) {
+            for (unsigned long stepMs : FRAME_STEPS_MS) {
+                std::vector<LEDNotifier> notifiers(1, LEDNotifier(9, ANALOG));
+                runUpdates(runner, notifiers, keyframes, mode, stepMs);
+            }
+        }
+    }
+}
+
+YBN_BENCH(servoUpdateMany) {
+    const int counts[] = {1, 8, 64};
+    for (int count : counts) {
+        std::vector<ServoNotifier> notifiers(count);
+        runUpdates(runner, notifiers, 16, PLAY_LOOP, 1);
+    }
+}
+
+YBN_BENCH(servoUpdateSharedNow) {
+    // Same as servoUpdateMany, but the frame reads the clock once and
+    // hands the timestamp to every notifier
+    const int counts[] = {1, 8, 64};
+    for (int count : counts) {
+        std::vector<ServoNotifier> notifiers(count);
+        KeyframeAnimation curve = fixtures::makeCurve("curve", 16);
+        host::setMicros(0);
+        for (int i = 0; i < count; i++) {
+            notifiers[i].playAnimation(curve, PLAY_LOOP);
+        }
+
+        runner.measure(label(16, PLAY_LOOP, 1, count), count, [&]() {
+            host::advanceMillis(1);
+            unsigned long now = millis();
+            for (int i = 0; i < count; i++) {
+                notifiers[i].update(now);
+            }
+            bench::keep(static_cast<long>(notifiers[0].getValue()));
+        });
+    }
+}
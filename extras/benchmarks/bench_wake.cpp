@@ -0,0 +1,162 @@
+// bench_wake.cpp
+// NotifierGroup::timeToNextChange(): a group that only wakes when told
+// to against one updated every millisecond. Counts wake-ups and checks
+// that no output change is ever missed, in both engines
+
+#include "bench.h"
+#include "engines.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+
+const int SERVO_COUNT = 8;
+const unsigned long RUN_MS = 30000;
+const unsigned long CROSSFADE_AT_MS = 12345;
+
+// Slow ramps, long holds, quick moves and eased curves
+template <typename Animation, typename Easing>
+std::vector<Animation> makeAnimations() {
+    std::vector<Animation> animations;
+    for (int i = 0; i < SERVO_COUNT; i++) {
+        Animation animation("wake");
+        animation.addKeyFrame(90, 0);
+        animation.addKeyFrame(90 + i, 4000 + 500 * i);                       // Slow ramp
+        animation.addKeyFrame(90 + i, 9000);                                 // Hold
+        animation.addKeyFrame(30, 9400, static_cast<Easing>(2 + i % 5));     // Quick eased move
+        animation.addKeyFrame(150, 14000 + 1000 * i, static_cast<Easing>(i % 2 ? 0 : 6));
+        animation.addKeyFrame(150, 20000);
+        animation.addKeyFrame(0, 20001 + 200 * i, static_cast<Easing>(i % 3 == 0 ? 1 : 0));
+        animations.push_back(animation);
+    }
+    return animations;
+}
+
+template <typename Group, typename Servo, typename Animation, typename Easing, typename Mode>
+void checkEngine(bench::Runner& runner, const char* engine, Mode mode, const char* modeName) {
+    std::vector<Animation> animations = makeAnimations<Animation, Easing>();
+    Animation settle("settle");
+    settle.addKeyFrame(45, 0);
+    settle.addKeyFrame(60, 3000);
+
+    // Reference: every millisecond, recording each servo's output
+    std::vector<std::vector<int>> outputs(RUN_MS + 1, std::vector<int>(SERVO_COUNT));
+    {
+        Group group;
+        std::vector<Servo> servos(SERVO_COUNT);
+        host::setMicros(0);
+        for (int i = 0; i < SERVO_COUNT; i++) {
+            servos[i].setValueScale(1.0f + 0.25f * i);
+            servos[i].setValueRange(0, 200);
+            group.add(servos[i]);
+            servos[i].playAnimation(animations[i], mode);
+        }
+        for (unsigned long now = 0; now <= RUN_MS; now++) {
+            host::setMicros(now * 1000);
+            if (now == CROSSFADE_AT_MS) {
+                group.update(now);
+                servos[3].crossfadeTo(settle, 800, mode);
+            }
+            group.update(now);
+            for (int i = 0; i < SERVO_COUNT; i++) {
+                outputs[now][i] = servos[i].getValue();
+            }
+        }
+    }
+
+    long changes = 0;
+    for (unsigned long t = 1; t <= RUN_MS; t++) {
+        changes += outputs[t] != outputs[t - 1];
+    }
+
+    // Sleeper: only wakes when the group says an output will change
+    Group group;
+    std::vector<Servo> servos(SERVO_COUNT);
+    host::setMicros(0);
+    for (int i = 0; i < SERVO_COUNT; i++) {
+        servos[i].setValueScale(1.0f + 0.25f * i);
+        servos[i].setValueRange(0, 200);
+        group.add(servos[i]);
+        servos[i].playAnimation(animations[i], mode);
+    }
+    long wakes = 0;
+    long missed = 0;
+    unsigned long now = 0;
+    while (now <= RUN_MS) {
+        host::setMicros(now * 1000);
+        if (now == CROSSFADE_AT_MS) {
+            // Crossfades start from the value of the last update
+            group.update(now);
+            servos[3].crossfadeTo(settle, 800, mode);
+        }
+        group.update(now);
+        wakes++;
+        for (int i = 0; i < SERVO_COUNT; i++) {
+            if (servos[i].getValue() != outputs[now][i]) {
+                missed++;
+            }
+        }
+
+        unsigned long wait = group.timeToNextChange(now);
+        unsigned long next = wait == 0 ? now + 1 : (wait > RUN_MS ? RUN_MS + 1 : now + wait);
+        if (now < CROSSFADE_AT_MS && next > CROSSFADE_AT_MS) {
+            next = CROSSFADE_AT_MS;   // The sketch's own event
+        }
+
+        // Nothing may change while asleep
+        for (unsigned long t = now + 1; t < next && t <= RUN_MS; t++) {
+            if (outputs[t] != outputs[now]) {
+                missed++;
+                break;
+            }
+        }
+        now = next;
+    }
+
+    char label[64];
+    std::snprintf(label, sizeof(label), "engine=%s mode=%s servos=%d", engine, modeName, SERVO_COUNT);
+    runner.report(label, wakes, "wake-ups");
+    runner.report(label, changes, "frames with a change");
+    runner.report(label, RUN_MS + 1, "frames at 1 ms");
+    if (missed > 0) {
+        runner.fail(label, "an output changed while the group was asleep");
+    }
+}
+
+} // namespace
+
+YBN_BENCH(wakeUps) {
+    checkEngine<ybn_float::NotifierGroup, ybn_float::ServoNotifier, ybn_float::KeyframeAnimation,
+                ybn_float::Easing>(runner, "float", ybn_float::PLAY_ONCE, "ONCE");
+    checkEngine<ybn_fixed::NotifierGroup, ybn_fixed::ServoNotifier, ybn_fixed::KeyframeAnimation,
+                ybn_fixed::Easing>(runner, "fixed", ybn_fixed::PLAY_ONCE, "ONCE");
+    checkEngine<ybn_float::NotifierGroup, ybn_float::ServoNotifier, ybn_float::KeyframeAnimation,
+                ybn_float::Easing>(runner, "float", ybn_float::PLAY_LOOP, "LOOP");
+    checkEngine<ybn_fixed::NotifierGroup, ybn_fixed::ServoNotifier, ybn_fixed::KeyframeAnimation,
+                ybn_fixed::Easing>(runner, "fixed", ybn_fixed::PLAY_LOOP, "LOOP");
+    checkEngine<ybn_float::NotifierGroup, ybn_float::ServoNotifier, ybn_float::KeyframeAnimation,
+                ybn_float::Easing>(runner, "float", ybn_float::PLAY_BOOMERANG, "BOOMERANG");
+    checkEngine<ybn_fixed::NotifierGroup, ybn_fixed::ServoNotifier, ybn_fixed::KeyframeAnimation,
+                ybn_fixed::Easing>(runner, "fixed", ybn_fixed::PLAY_BOOMERANG, "BOOMERANG");
+}
+
+YBN_BENCH(timeToNextChange) {
+    // Cost of the query itself for a group of playing servos
+    std::vector<ybn_float::KeyframeAnimation> animations =
+        makeAnimations<ybn_float::KeyframeAnimation, ybn_float::Easing>();
+    ybn_float::NotifierGroup group;
+    std::vector<ybn_float::ServoNotifier> servos(SERVO_COUNT);
+    host::setMicros(0);
+    for (int i = 0; i < SERVO_COUNT; i++) {
+        group.add(servos[i]);
+        servos[i].playAnimation(animations[i], ybn_float::PLAY_LOOP);
+    }
+    unsigned long now = 0;
+    runner.measure("servos=8 mode=LOOP", SERVO_COUNT, [&]() {
+        now = (now + 7) % RUN_MS;
+        group.update(now);
+        bench::keep(static_cast<long>(group.timeToNextChange(now)));
+    });
+}
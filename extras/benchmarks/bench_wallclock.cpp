@@ -0,0 +1,196 @@
+// bench_wallclock.cpp
+// Scheduled playback from a shared wall clock: two simulated boards, one
+// with a clock running 150 ppm fast, play the same show for an hour.
+// Compares playAt() with WallClock against polling the RTC's seconds and
+// calling playAnimation(), the way the RTC examples start their cues
+
+#include "bench.h"
+#include "fixtures.h"
+
+#include <cmath>
+#include <cstdio>
+
+namespace {
+
+const unsigned long EPOCH = 1700000000UL;      // RTC reading at virtual time 0...
+const unsigned long EPOCH_PHASE_US = 420000;   // ...this far into the second
+const unsigned long SHOW_AT = EPOCH + 10;      // Show start, epoch seconds
+const unsigned long SHOW_MS = 4000;
+const unsigned long RUN_MS = 60UL * 60 * 1000;
+
+// Board B boots later and its crystal runs fast
+unsigned long boardBMillis() {
+    return static_cast<unsigned long>(micros() * 1.00015 / 1000.0) + 98765;
+}
+
+const TimeSource BOARD_CLOCKS[] = {MICROS_CLOCK, {boardBMillis, 1}};
+
+KeyframeAnimation makeShow() {
+    KeyframeAnimation show("show");
+    show.addKeyFrame(90, 0);
+    show.addKeyFrame(170, 1500);
+    show.addKeyFrame(10, 3000);
+    show.addKeyFrame(90, SHOW_MS);
+    return show;
+}
+
+// Signed difference between two positions in a loop, -SHOW_MS/2 to SHOW_MS/2
+double loopDifference(double a, double b) {
+    double difference = std::fmod(a - b + 1.5 * SHOW_MS, static_cast<double>(SHOW_MS)) - 0.5 * SHOW_MS;
+    return difference;
+}
+
+} // namespace
+
+YBN_BENCH(wallClockLockstep) {
+    KeyframeAnimation show = makeShow();
+    const char* methods[] = {"polled", "playAt"};
+    for (int method = 0; method < 2; method++) {
+        host::setMicros(0);
+        host::setEpochSeconds(EPOCH, EPOCH_PHASE_US);
+        double showStartUs = (SHOW_AT - EPOCH) * 1e6 - EPOCH_PHASE_US;
+
+        ServoNotifier servos[2];
+        WallClock* walls[2] = {nullptr, nullptr};
+        for (int b = 0; b < 2; b++) {
+            servos[b].setTimeSource(BOARD_CLOCKS[b]);
+            if (method == 1) {
+                walls[b] = new WallClock(host::epochSeconds);
+                walls[b]->setTimeSource(BOARD_CLOCKS[b]);
+                if (!walls[b]->sync()) {
+                    runner.fail(methods[method], "WallClock::sync() saw no change of second");
+                }
+                servos[b].playAt(show, *walls[b], SHOW_AT, PLAY_LOOP);
+            }
+        }
+
+        double largestError[2] = {0, 0};
+        double largestSpread = 0;
+        unsigned long seed = 7;
+        unsigned long nextSync = 60000;
+        while (micros() < RUN_MS * 1000UL) {
+            seed = seed * 1103515245UL + 12345UL;
+            host::advanceMicros((seed >> 8) % 20000);
+            for (int b = 0; b < 2; b++) {
+                if (method == 0) {
+                    if (!servos[b].isPlaying() && host::epochSeconds() >= SHOW_AT) {
+                        servos[b].playAnimation(show, PLAY_LOOP);
+                    }
+                } else {
+                    walls[b]->update();
+                    if (millis() >= nextSync) {
+                        servos[b].syncToWallClock();
+                    }
+                }
+                servos[b].update();
+            }
+            if (millis() >= nextSync) {
+                nextSync += 60000;
+            }
+
+            // Compare once the show has been running a while
+            double showMs = (micros() - showStartUs) / 1000.0;
+            if (showMs < 1000) {
+                continue;
+            }
+            double positions[2];
+            for (int b = 0; b < 2; b++) {
+                positions[b] = servos[b].getElapsedTime();
+                double error = std::fabs(loopDifference(positions[b], std::fmod(showMs, SHOW_MS)));
+                largestError[b] = std::fmax(largestError[b], error);
+            }
+            largestSpread = std::fmax(largestSpread, std::fabs(loopDifference(positions[0], positions[1])));
+        }
+
+        char label[64];
+        for (int b = 0; b < 2; b++) {
+            std::snprintf(label, sizeof(label), "start=%s board=%s", methods[method], b == 0 ? "A" : "B+150ppm");
+            runner.report(label, largestError[b], "max ms from the wall clock");
+            delete walls[b];
+        }
+        std::snprintf(label, sizeof(label), "start=%s", methods[method]);
+        runner.report(label, largestSpread, "max ms between boards");
+        if (method == 1 && largestSpread > 25) {
+            runner.fail(label, "boards fell out of step");
+        }
+    }
+}
+
+YBN_BENCH(wallClockSchedule) {
+    // A start in the future holds the first keyframe; one in the past
+    // joins the show partway through
+    KeyframeAnimation show = makeShow();
+    host::setMicros(0);
+    host::setEpochSeconds(EPOCH, EPOCH_PHASE_US);
+    WallClock wall(host::epochSeconds);
+    wall.sync();
+    ServoNotifier early;
+    early.playAt(show, wall, host::epochSeconds() + 5, PLAY_ONCE);   // sync() left us at ms 0
+    early.update();
+    unsigned long wait = early.timeToNextChange();
+    if (early.getValue() != 90 || wait < 5000 || wait > 5100) {
+        runner.fail("future", "does not hold the first keyframe until the start");
+    }
+    runner.report("future", wait, "ms until the first change");
+
+    host::advanceMillis(1500);
+    wall.update();
+    ServoNotifier late;
+    late.playAt(show, wall, EPOCH - 1, PLAY_LOOP);   // Started 3.5 s ago
+    late.update();
+    ServoNotifier reference;
+    reference.playAnimation(show, PLAY_LOOP);
+    reference.seek(static_cast<unsigned long>(wall.msSince(EPOCH - 1)));
+    reference.update();
+    if (late.getValue() != reference.getValue()) {
+        runner.fail("past", "does not join the show where the wall clock says");
+    }
+    runner.report("past", late.getElapsedTime(), "ms into the show");
+
+    // Anchors long past, in every mode and at two speeds, against the
+    // animation time worked out exactly from the wall time. Also a start
+    // further off than the clock can count, which holds
+    const unsigned long AGES[] = {30UL * 24 * 60 * 60, 10UL * 365 * 24 * 60 * 60 + 123};
+    const float SPEEDS[] = {1.0f, 1.3f};
+    const PlayMode modes[] = {PLAY_ONCE, PLAY_LOOP, PLAY_BOOMERANG};
+    for (unsigned long age : AGES) {
+        for (float speed : SPEEDS) {
+            for (int m = 0; m < 3; m++) {
+                int ms;
+                long seconds = wall.secondsSince(EPOCH - age, ms);
+                int exponent;
+                unsigned long long mantissa = std::ldexp(std::frexp(speed, &exponent), 24);
+                unsigned __int128 scaled = (static_cast<unsigned __int128>(seconds) * 1000 + ms) * mantissa;
+                unsigned __int128 rounded = (scaled + (static_cast<unsigned __int128>(1) << (23 - exponent))) >> (24 - exponent);
+                unsigned long cycle = m == 2 ? 2 * SHOW_MS : SHOW_MS;
+                unsigned long expected = m == 0 ? SHOW_MS : static_cast<unsigned long>(rounded % cycle);
+
+                ServoNotifier old;
+                old.setGlobalSpeed(speed);
+                old.playAt(show, wall, EPOCH - age, modes[m]);
+                ServoNotifier played;
+                played.setGlobalSpeed(speed);
+                played.playAnimation(show, modes[m]);
+                played.seek(expected);
+                char label[64];
+                std::snprintf(label, sizeof(label), "age=%lus speed=%.1f mode=%d", age, speed, m);
+                if (old.getValue() != played.getValue() || old.getElapsedTime() != played.getElapsedTime()) {
+                    runner.fail(label, "an old anchor does not join the show where the wall clock says");
+                }
+            }
+        }
+    }
+    ServoNotifier distant;
+    distant.playAt(show, wall, host::epochSeconds() + 100UL * 24 * 60 * 60, PLAY_LOOP);
+    bool held = true;
+    for (int day = 0; day < 30; day++) {
+        host::advanceMillis(24UL * 60 * 60 * 1000);
+        wall.update();
+        distant.syncToWallClock();
+        distant.update();
+        held = held && distant.getValue() == 90 && distant.timeToNextChange() > 0;
+    }
+    if (!held) {
+        runner.fail("distant", "a start 100 days off must hold the first keyframe");
+    }
+}
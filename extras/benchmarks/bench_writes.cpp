@@ -0,0 +1,114 @@
+// bench_writes.cpp
+// Output change tracking: hasChanged() kept per notifier, and pin
+// writes skipped when the output level has not changed
+
+#include "bench.h"
+#include "fixtures.h"
+
+#include <cstdio>
+
+namespace {
+
+const unsigned long RUN_MS = 10000;
+
+} // namespace
+
+YBN_BENCH(hasChangedPerNotifier) {
+    // Two servos on different curves, polled like the examples do. Each
+    // must report exactly its own changes
+    KeyframeAnimation slow = fixtures::makeCurve("slow", 4);
+    KeyframeAnimation fast = fixtures::makeCurve("fast", 64);
+    ServoNotifier first;
+    ServoNotifier second;
+    host::setMicros(0);
+    first.playAnimation(slow, PLAY_LOOP);
+    second.playAnimation(fast, PLAY_LOOP);
+
+    long reported[2] = {0, 0};
+    long actual[2] = {0, 0};
+    int previous[2] = {-1, -1};
+    ServoNotifier* servos[] = {&first, &second};
+    for (unsigned long ms = 0; ms < RUN_MS; ms++) {
+        host::setMicros(ms * 1000);
+        for (int i = 0; i < 2; i++) {
+            servos[i]->update();
+            int value = servos[i]->getValue();
+            actual[i] += value != previous[i];
+            previous[i] = value;
+            reported[i] += servos[i]->hasChanged();
+        }
+    }
+    const char* labels[] = {"servo=slow", "servo=fast"};
+    for (int i = 0; i < 2; i++) {
+        runner.report(labels[i], reported[i], "changes reported");
+        runner.report(labels[i], RUN_MS, "updates");
+        if (reported[i] != actual[i]) {
+            runner.fail(labels[i], "hasChanged() does not match this notifier's changes");
+        }
+    }
+}
+
+YBN_BENCH(ledWrites) {
+    // A slow fade updated every 250 us: most updates leave the PWM level
+    // where it was
+    const LEDMode modes[] = {ANALOG, DIGITAL};
+    const char* labels[] = {"mode=ANALOG", "mode=DIGITAL"};
+    for (int m = 0; m < 2; m++) {
+        KeyframeAnimation fade("fade");
+        fade.addKeyFrame(0, 0);
+        fade.addKeyFrame(255, RUN_MS / 2);
+        fade.addKeyFrame(0, RUN_MS);
+        LEDNotifier led(9, modes[m]);
+        led.setTimeSource(MICROS_CLOCK);
+        host::setMicros(0);
+        led.begin();
+        led.playAnimation(fade, PLAY_ONCE);
+        host::resetPins();
+
+        long updates = 0;
+        long changes = 0;
+        int level = -1;
+        for (unsigned long us = 0; us <= RUN_MS * 1000; us += 250) {
+            host::setMicros(us);
+            led.update();
+            updates++;
+            int value = led.getValue();
+            int expected = modes[m] == ANALOG ? constrain(value, 0, 255) : (value >= 0.5f ? HIGH : LOW);
+            changes += expected != level;
+            level = expected;
+            if (host::pinValue(9) != level) {
+                runner.fail(labels[m], "pin does not hold the current level");
+                break;
+            }
+        }
+        runner.report(labels[m], updates, "updates");
+        runner.report(labels[m], host::pinWriteCount(), "pin writes");
+        runner.report(labels[m], led.getSkippedWrites(), "skipped writes");
+        if (static_cast<long>(host::pinWriteCount()) != changes ||
+            static_cast<long>(led.getSkippedWrites()) != updates - changes) {
+            runner.fail(labels[m], "writes do not match level changes");
+        }
+    }
+
+    // RGB: three pins written only when the colour changes
+    RGBKeyframeAnimation glow("glow");
+    glow.addKeyFrame(0, 0, 0, 0);
+    glow.addKeyFrame(40, 10, 80, RUN_MS);
+    RGBNotifier light(3, 5, 6);
+    host::setMicros(0);
+    light.begin();
+    light.playAnimation(glow, PLAY_ONCE);
+    host::resetPins();
+    long updates = 0;
+    for (unsigned long ms = 0; ms <= RUN_MS; ms++) {
+        host::setMicros(ms * 1000);
+        light.update();
+        updates++;
+    }
+    runner.report("rgb", updates, "updates");
+    runner.report("rgb", host::pinWriteCount(), "pin writes");
+    runner.report("rgb", light.getSkippedWrites(), "skipped writes");
+    if (host::pinValue(3) != 40 || host::pinValue(5) != 10 || host::pinValue(6) != 80) {
+        runner.fail("rgb", "final colour not written");
+    }
+}
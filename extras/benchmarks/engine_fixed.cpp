@@ -0,0 +1,13 @@
+// engine_fixed.cpp
+// Q16.16 build of the library inside namespace ybn_fixed (see engines.h)
+
+#include <Arduino.h>
+#include <Servo.h>
+#include <cstdint>
+#include <limits.h>
+#include <vector>
+
+#define YBN_FIXED_POINT 1
+namespace ybn_fixed {
+#include "YouveBeenNotified.cpp"
+}
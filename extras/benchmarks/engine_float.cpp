@@ -0,0 +1,13 @@
+// engine_float.cpp
+// Float build of the library inside namespace ybn_float (see engines.h)
+
+#include <Arduino.h>
+#include <Servo.h>
+#include <cstdint>
+#include <limits.h>
+#include <vector>
+
+#define YBN_FIXED_POINT 0
+namespace ybn_float {
+#include "YouveBeenNotified.cpp"
+}
@@ -0,0 +1,32 @@
+// engines.h
+// Declares two builds of the library side by side: ybn_float (the
+// default float engine) and ybn_fixed (YBN_FIXED_POINT=1). Each is the
+// unmodified header wrapped in a namespace; engine_float.cpp and
+// engine_fixed.cpp compile the matching implementations.
+//
+// Only include this from files that do not include YouveBeenNotified.h
+
+#ifndef YBN_BENCH_ENGINES_H
+#define YBN_BENCH_ENGINES_H
+
+// Everything the library includes must be pulled in here first, outside
+// the namespaces, so the include guards keep it out of them
+#include <Arduino.h>
+#include <Servo.h>
+#include <cstdint>
+#include <vector>
+
+#undef YBN_FIXED_POINT
+#define YBN_FIXED_POINT 0
+namespace ybn_float {
+#include "YouveBeenNotified.h"
+}
+
+#undef YOUVEBEENNOTIFIED_H
+#undef YBN_FIXED_POINT
+#define YBN_FIXED_POINT 1
+namespace ybn_fixed {
+#include "YouveBeenNotified.h"
+}
+
+#endif // YBN_BENCH_ENGINES_H
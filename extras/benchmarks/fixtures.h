@@ -0,0 +1,40 @@
+// fixtures.h
+// Shared animation builders for the benchmark cases
+
+#ifndef YBN_BENCH_FIXTURES_H
+#define YBN_BENCH_FIXTURES_H
+
+#include "YouveBeenNotified.h"
+
+namespace fixtures {
+
+// Total length of every generated curve, independent of keyframe count
+const unsigned long CURVE_DURATION_MS = 10000;
+
+// Deterministic pseudo-random curve with evenly spaced keyframes,
+// values in 0-180 like a servo angle list
+inline KeyframeAnimation makeCurve(const String& name, int keyframeCount) {
+    KeyframeAnimation animation(name);
+    unsigned long seed = 12345;
+    for (int i = 0; i < keyframeCount; i++) {
+        seed = seed * 1103515245UL + 12345UL;
+        float value = static_cast<float>((seed >> 16) % 181);
+        unsigned long time = keyframeCount > 1
+            ? CURVE_DURATION_MS * i / (keyframeCount - 1)
+            : 0;
+        animation.addKeyFrame(value, time);
+    }
+    return animation;
+}
+
+inline const char* modeName(PlayMode mode) {
+    switch (mode) {
+        case PLAY_ONCE: return "ONCE";
+        case PLAY_LOOP: return "LOOP";
+        default: return "BOOMERANG";
+    }
+}
+
+} // namespace fixtures
+
+#endif // YBN_BENCH_FIXTURES_H
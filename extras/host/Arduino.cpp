@@ -0,0 +1,85 @@
+// Arduino.cpp
+// Host implementation of the Arduino core shim
+
+#include "Arduino.h"
+
+namespace {
+    const int PIN_COUNT = 256;
+
+    unsigned long virtualMicros = 0;
+    int pinValues[PIN_COUNT] = {0};
+    unsigned long pinWrites = 0;
+    unsigned long epochMicrosBase = 0;   // Virtual time at which the RTC read 0
+}
+
+unsigned long millis() {
+    return virtualMicros / 1000;
+}
+
+unsigned long micros() {
+    return virtualMicros;
+}
+
+void delay(unsigned long ms) {
+    virtualMicros += ms * 1000;
+}
+
+void delayMicroseconds(unsigned int us) {
+    virtualMicros += us;
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    (void)pin;
+    (void)mode;
+}
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+    pinValues[pin] = val;
+    pinWrites++;
+}
+
+int digitalRead(uint8_t pin) {
+    return pinValues[pin] ? HIGH : LOW;
+}
+
+void analogWrite(uint8_t pin, int val) {
+    pinValues[pin] = val;
+    pinWrites++;
+}
+
+namespace host {
+    void setMicros(unsigned long us) {
+        virtualMicros = us;
+    }
+
+    void advanceMicros(unsigned long us) {
+        virtualMicros += us;
+    }
+
+    void advanceMillis(unsigned long ms) {
+        virtualMicros += ms * 1000;
+    }
+
+    void setEpochSeconds(unsigned long seconds, unsigned long microsIntoSecond) {
+        epochMicrosBase = virtualMicros - seconds * 1000000UL - microsIntoSecond;
+    }
+
+    unsigned long epochSeconds() {
+        return (virtualMicros - epochMicrosBase) / 1000000UL;
+    }
+
+    int pinValue(uint8_t pin) {
+        return pinValues[pin];
+    }
+
+    unsigned long pinWriteCount() {
+        return pinWrites;
+    }
+
+    void resetPins() {
+        for (int i = 0; i < PIN_COUNT; i++) {
+            pinValues[i] = 0;
+        }
+        pinWrites = 0;
+    }
+}
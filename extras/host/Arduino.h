@@ -0,0 +1,92 @@
+// Arduino.h
+// Minimal Arduino core shim for building the library on a desktop host
+// Time comes from a virtual clock that the host program drives
+
+#ifndef ARDUINO_HOST_SHIM_H
+#define ARDUINO_HOST_SHIM_H
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH 0x1
+#define LOW  0x0
+
+#define INPUT  0x0
+#define OUTPUT 0x1
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+// ----------------------------------------------------------------
+// String
+// Subset of the Arduino String API backed by std::string
+// ----------------------------------------------------------------
+class String {
+private:
+    std::string buffer;
+
+public:
+    String(const char* cstr = "") : buffer(cstr ? cstr : "") {}
+    String(const std::string& str) : buffer(str) {}
+    explicit String(int value) : buffer(std::to_string(value)) {}
+    explicit String(long value) : buffer(std::to_string(value)) {}
+    explicit String(unsigned long value) : buffer(std::to_string(value)) {}
+
+    unsigned int length() const { return buffer.size(); }
+    const char* c_str() const { return buffer.c_str(); }
+    char operator[](unsigned int index) const { return buffer[index]; }
+
+    bool equals(const String& other) const { return buffer == other.buffer; }
+    bool operator==(const String& other) const { return buffer == other.buffer; }
+    bool operator==(const char* other) const { return buffer == other; }
+    bool operator!=(const String& other) const { return buffer != other.buffer; }
+    bool operator!=(const char* other) const { return buffer != other; }
+
+    String& operator+=(const String& other) { buffer += other.buffer; return *this; }
+    String& operator+=(const char* other) { buffer += other; return *this; }
+    String& operator+=(int value) { buffer += std::to_string(value); return *this; }
+
+    friend String operator+(String lhs, const String& rhs) { return lhs += rhs; }
+    friend String operator+(String lhs, const char* rhs) { return lhs += rhs; }
+    friend String operator+(String lhs, int rhs) { return lhs += rhs; }
+};
+
+// ----------------------------------------------------------------
+// Core functions
+// ----------------------------------------------------------------
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+void analogWrite(uint8_t pin, int val);
+
+// ----------------------------------------------------------------
+// Host controls
+// Not part of the Arduino API: lets host programs drive the clock
+// and inspect what was written to the pins
+// ----------------------------------------------------------------
+namespace host {
+    void setMicros(unsigned long us);
+    void advanceMicros(unsigned long us);
+    void advanceMillis(unsigned long ms);
+
+    // Simulated RTC: whole seconds since the epoch, ticking with the
+    // virtual clock. At the current virtual time it reads seconds and is
+    // microsIntoSecond into that second
+    void setEpochSeconds(unsigned long seconds, unsigned long microsIntoSecond = 0);
+    unsigned long epochSeconds();
+
+    int pinValue(uint8_t pin);
+    unsigned long pinWriteCount();
+    void resetPins();
+}
+
+#endif // ARDUINO_HOST_SHIM_H
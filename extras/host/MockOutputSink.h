@@ -0,0 +1,33 @@
+// MockOutputSink.h
+// Host stand-in for batched output hardware such as a PWM expander
+// Records each transaction instead of talking to a bus
+
+#ifndef MOCK_OUTPUT_SINK_HOST_SHIM_H
+#define MOCK_OUTPUT_SINK_HOST_SHIM_H
+
+#include "YouveBeenNotified.h"
+
+#include <vector>
+
+class MockOutputSink : public OutputSink {
+private:
+    std::vector<uint16_t> hardware;   // Levels as the device last received them
+    unsigned long channelWrites;      // Channels carried by all transactions
+
+protected:
+    void send(int first, int count, const uint16_t* levels) override {
+        for (int i = 0; i < count; i++) {
+            hardware[first + i] = levels[i];
+        }
+        channelWrites += count;
+    }
+
+public:
+    explicit MockOutputSink(int channelCount)
+        : OutputSink(channelCount), hardware(channelCount, 0), channelWrites(0) {}
+
+    uint16_t hardwareLevel(int channel) const { return hardware[channel]; }
+    unsigned long getChannelWrites() const { return channelWrites; }
+};
+
+#endif // MOCK_OUTPUT_SINK_HOST_SHIM_H
@@ -0,0 +1,31 @@
+// Servo.h
+// Host stand-in for the Arduino Servo library
+// Remembers the last written angle instead of driving a pin
+
+#ifndef SERVO_HOST_SHIM_H
+#define SERVO_HOST_SHIM_H
+
+#include "Arduino.h"
+
+class Servo {
+private:
+    int pin;
+    int angle;
+    unsigned long writes;
+
+public:
+    Servo() : pin(-1), angle(90), writes(0) {}
+
+    uint8_t attach(int newPin) { pin = newPin; return 1; }
+    uint8_t attach(int newPin, int min, int max) { (void)min; (void)max; return attach(newPin); }
+    void detach() { pin = -1; }
+    bool attached() const { return pin >= 0; }
+
+    void write(int value) { angle = value; writes++; }
+    int read() const { return angle; }
+
+    // Host only: number of write() calls so far
+    unsigned long writeCount() const { return writes; }
+};
+
+#endif // SERVO_HOST_SHIM_H
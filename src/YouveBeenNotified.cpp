@@ -2,135 +2,1457 @@
 // Implementation for the animation classes
 
 #include "YouveBeenNotified.h"
+#include <limits.h>
+
+//======================================================================
+// TimeSource Implementation
+//======================================================================
+
+static TimeSource defaultTimeSource = MILLIS_CLOCK;
+
+void setDefaultTimeSource(const TimeSource& source) {
+    if (source.now == nullptr || source.ticksPerMs == 0) {
+        return;
+    }
+    defaultTimeSource = source;
+}
+
+const TimeSource& getDefaultTimeSource() {
+    return defaultTimeSource;
+}
+
+//======================================================================
+// WallClock Implementation
+//======================================================================
+
+WallClock::WallClock(unsigned long (*epochSeconds)())
+    : readSeconds(epochSeconds),
+      timeSource(),
+      baseSeconds(0),
+      baseMillis(0),
+      baseTick(0),
+      lastSeconds(0),
+      started(false),
+      synced(false) {
+}
+
+void WallClock::setTimeSource(const TimeSource& source) {
+    timeSource = source;
+    started = false;
+    synced = false;
+}
+
+const TimeSource& WallClock::clock() const {
+    return timeSource.now != nullptr ? timeSource : getDefaultTimeSource();
+}
+
+void WallClock::setBase(unsigned long seconds, long ms, unsigned long tick) {
+    baseSeconds = seconds;
+    baseMillis = ms;
+    baseTick = tick;
+    lastSeconds = seconds;
+    started = true;
+}
+
+bool WallClock::sync(unsigned long timeoutMs) {
+    const TimeSource& source = clock();
+    unsigned long first = readSeconds();
+    unsigned long begin = source.now();
+    while (source.now() - begin < timeoutMs * source.ticksPerMs) {
+        unsigned long seconds = readSeconds();
+        if (seconds != first) {
+            // The second has only just begun
+            setBase(seconds, 0, source.now());
+            synced = true;
+            return true;
+        }
+        delayMicroseconds(50);
+    }
+    return false;
+}
+
+void WallClock::update() {
+    const TimeSource& source = clock();
+    unsigned long seconds = readSeconds();
+    unsigned long now = source.now();
+    if (!started) {
+        // Somewhere in this second; take its start until it changes
+        setBase(seconds, 0, now);
+        return;
+    }
+    
+    // Wall time by the local clock, in ms past the second just read.
+    // The base moves on in whole ms and keeps the leftover ticks
+    unsigned long elapsedMs = (now - baseTick) / source.ticksPerMs;
+    long ms = static_cast<long>(baseSeconds - seconds) * 1000 + baseMillis + static_cast<long>(elapsedMs);
+    if (seconds != lastSeconds && !synced) {
+        ms = 0;   // The first change of second marks ms 0
+        synced = true;
+    }
+    
+    // The reading wins: pull the ms back inside its second, by as little
+    // as possible, which also takes out the local clock's drift
+    ms = constrain(ms, 0L, 999L);
+    setBase(seconds, ms, baseTick + elapsedMs * source.ticksPerMs);
+}
+
+bool WallClock::isSynced() const {
+    return synced;
+}
+
+long WallClock::secondsSince(unsigned long epochSeconds, int& ms) const {
+    if (!started) {
+        ms = 0;
+        return static_cast<long>(readSeconds() - epochSeconds);
+    }
+    const TimeSource& source = clock();
+    unsigned long elapsedMs = baseMillis + (source.now() - baseTick) / source.ticksPerMs;
+    ms = elapsedMs % 1000;
+    return static_cast<long>(baseSeconds - epochSeconds + elapsedMs / 1000);
+}
+
+long WallClock::msSince(unsigned long epochSeconds) const {
+    int ms;
+    return secondsSince(epochSeconds, ms) * 1000 + ms;
+}
 
 //======================================================================
 // KeyframeAnimation Implementation
 //======================================================================
 
-KeyframeAnimation::KeyframeAnimation(const String& name) : name(name) {
-    // Initialize with empty keyframe list
+// Keyframe tables may live in flash, which AVR reads with separate
+// instructions
+#if defined(__AVR__)
+static inline unsigned long readKeyframeTime(const Keyframe* keyframe) {
+    return pgm_read_dword(&keyframe->time);
+}
+
+static inline float readKeyframeValue(const Keyframe* keyframe) {
+    return pgm_read_float(&keyframe->value);
+}
+#else
+static inline unsigned long readKeyframeTime(const Keyframe* keyframe) {
+    return keyframe->time;
+}
+
+static inline float readKeyframeValue(const Keyframe* keyframe) {
+    return keyframe->value;
+}
+#endif
+
+// Indexes a keyframe table's times like an array
+struct TableTimes {
+    const Keyframe* table;
+    unsigned long operator[](int index) const {
+        return readKeyframeTime(&table[index]);
+    }
+};
+
+KeyframeAnimation::KeyframeAnimation(const String& name)
+    : name(name),
+      nameHash(hashAnimationName(name)),
+      table(nullptr),
+      tableCount(0) {
+    // Initialize with empty keyframe list
+    unbake();
+}
+
+KeyframeAnimation::KeyframeAnimation(const String& name, const Keyframe* table, int count)
+    : name(name),
+      nameHash(hashAnimationName(name)),
+      table(table),
+      tableCount(count) {
+    unbake();
+}
+
+void KeyframeAnimation::reserve(int keyframeCount) {
+    times.reserve(keyframeCount);
+    values.reserve(keyframeCount);
+    slopes.reserve(keyframeCount);
+#if YBN_FIXED_POINT
+    fixedValues.reserve(keyframeCount);
+    fixedSlopes.reserve(keyframeCount);
+#endif
+    if (!easings.empty()) {
+        easings.reserve(keyframeCount);
+        bezierControls.reserve(keyframeCount * 2);
+        curves.reserve(keyframeCount);
+    }
+}
+
+void KeyframeAnimation::addKeyFrame(float value, unsigned long time, Easing easing) {
+    if (table != nullptr) {
+        return;   // Tables are read-only
+    }
+    unbake();
+    times.push_back(time);
+    values.push_back(value);
+    slopes.push_back(0.0f);
+#if YBN_FIXED_POINT
+    fixedValues.push_back(toFixed(value));
+    fixedSlopes.push_back(0);
+#endif
+    if (easing != LINEAR || !easings.empty()) {
+        useEasings();
+        easings.back() = easing;
+    }
+    updateSlopesAround(times.size() - 1);
+}
+
+void KeyframeAnimation::useEasings() {
+    // Grow the easing arrays to one entry per keyframe; new entries are
+    // LINEAR, with BEZIER controls that match EASE_IN_OUT
+    easings.resize(times.size(), LINEAR);
+    while (bezierControls.size() < times.size() * 2) {
+        bezierControls.push_back(0.0f);
+        bezierControls.push_back(1.0f);
+    }
+    curves.resize(times.size());
+}
+
+bool KeyframeAnimation::setKeyFrameEasing(int index, Easing easing) {
+    if (table != nullptr || index < 0 || index >= static_cast<int>(times.size())) {
+        return false;
+    }
+    if (easing == LINEAR && easings.empty()) {
+        return true;
+    }
+    unbake();
+    useEasings();
+    easings[index] = easing;
+    updateSlope(index - 1);
+    return true;
+}
+
+Easing KeyframeAnimation::getKeyFrameEasing(int index) const {
+    if (index < 0 || index >= static_cast<int>(easings.size())) {
+        return LINEAR;
+    }
+    return static_cast<Easing>(easings[index]);
+}
+
+bool KeyframeAnimation::setKeyFrameBezier(int index, float control1, float control2) {
+    if (table != nullptr || index < 0 || index >= static_cast<int>(times.size())) {
+        return false;
+    }
+    useEasings();
+    bezierControls[index * 2] = control1;
+    bezierControls[index * 2 + 1] = control2;
+    return setKeyFrameEasing(index, BEZIER);
+}
+
+bool KeyframeAnimation::setKeyFrameValue(int index, float newValue) {
+    if (table != nullptr || index < 0 || index >= static_cast<int>(times.size())) {
+        return false;
+    }
+    unbake();
+    values[index] = newValue;
+#if YBN_FIXED_POINT
+    fixedValues[index] = toFixed(newValue);
+#endif
+    
+    updateSlopesAround(index);
+    return true;
+}
+
+bool KeyframeAnimation::setKeyFrameTime(int index, unsigned long newTime) {
+    if (table != nullptr || index < 0 || index >= static_cast<int>(times.size())) {
+        return false;
+    }
+    unbake();
+    times[index] = newTime;
+    updateSlopesAround(index);
+    return true;
+}
+
+// Keep the entries of items whose keep flag is set, stride entries per keyframe
+template <typename T>
+static void keepKeyframes(std::vector<T>& items, const std::vector<bool>& keep, int stride) {
+    if (items.empty()) {
+        return;
+    }
+    int kept = 0;
+    for (int i = 0; i < static_cast<int>(keep.size()); i++) {
+        if (keep[i]) {
+            for (int j = 0; j < stride; j++) {
+                items[kept * stride + j] = items[i * stride + j];
+            }
+            kept++;
+        }
+    }
+    items.resize(kept * stride);
+    std::vector<T>(items).swap(items);   // Give back the spare capacity
+}
+
+bool KeyframeAnimation::isSimplifyAnchor(int index) const {
+    int last = times.size() - 1;
+    if (index == 0 || index == last) {
+        return true;
+    }
+    
+    // Either segment eased, or either one an instant jump
+    if (getKeyFrameEasing(index) != LINEAR || getKeyFrameEasing(index + 1) != LINEAR) {
+        return true;
+    }
+    
+    // A neighbour of a Catmull-Rom segment, which shapes its tangents
+    if (getKeyFrameEasing(index - 1) == CATMULL_ROM || getKeyFrameEasing(index + 2) == CATMULL_ROM) {
+        return true;
+    }
+    return times[index - 1] == times[index] || times[index] == times[index + 1];
+}
+
+int KeyframeAnimation::simplify(float tolerance, float* maxError) {
+    if (maxError != nullptr) {
+        *maxError = 0.0f;
+    }
+    int count = times.size();
+    if (table != nullptr || !colors.empty() || count < 3) {
+        return 0;
+    }
+    
+    // Split at every anchor, then Ramer-Douglas-Peucker on each run with
+    // an explicit stack of ranges, so long recordings cannot overflow the
+    // call stack. Values are linear between keyframes, so the largest
+    // error always falls on a removed keyframe
+    std::vector<bool> keep(count, false);
+    std::vector<int> ranges;
+    int runStart = 0;
+    keep[0] = true;
+    for (int i = 1; i < count; i++) {
+        if (isSimplifyAnchor(i)) {
+            keep[i] = true;
+            if (i - runStart > 1) {
+                ranges.push_back(runStart);
+                ranges.push_back(i);
+            }
+            runStart = i;
+        }
+    }
+    
+    float largest = 0.0f;
+    while (!ranges.empty()) {
+        int end = ranges.back();
+        ranges.pop_back();
+        int start = ranges.back();
+        ranges.pop_back();
+        
+        float slope = (values[end] - values[start]) / (times[end] - times[start]);
+        int worst = -1;
+        float worstError = 0.0f;
+        for (int i = start + 1; i < end; i++) {
+            float line = values[start] + slope * (times[i] - times[start]);
+            float error = fabsf(values[i] - line);
+            if (error > worstError) {
+                worstError = error;
+                worst = i;
+            }
+        }
+        
+        if (worst < 0 || worstError <= tolerance) {
+            largest = worstError > largest ? worstError : largest;
+            continue;
+        }
+        keep[worst] = true;
+        if (worst - start > 1) {
+            ranges.push_back(start);
+            ranges.push_back(worst);
+        }
+        if (end - worst > 1) {
+            ranges.push_back(worst);
+            ranges.push_back(end);
+        }
+    }
+    
+    keepKeyframes(times, keep, 1);
+    keepKeyframes(values, keep, 1);
+    keepKeyframes(slopes, keep, 1);
+#if YBN_FIXED_POINT
+    keepKeyframes(fixedValues, keep, 1);
+    keepKeyframes(fixedSlopes, keep, 1);
+#endif
+    keepKeyframes(easings, keep, 1);
+    keepKeyframes(bezierControls, keep, 2);
+    keepKeyframes(curves, keep, 1);
+    
+    unbake();
+    for (int segment = 0; segment + 1 < static_cast<int>(times.size()); segment++) {
+        updateSlope(segment);
+    }
+    
+    if (maxError != nullptr) {
+        *maxError = largest;
+    }
+    return count - times.size();
+}
+
+void KeyframeAnimation::updateSlopesAround(int index) {
+    // Only the two segments touching a keyframe change, unless there are
+    // Catmull-Rom segments, which also depend on the keyframes either side
+    int reach = easings.empty() ? 1 : 2;
+    for (int segment = index - reach; segment < index + reach; segment++) {
+        updateSlope(segment);
+    }
+}
+
+// Catmull-Rom tangent at keyframe index, in value per ms
+static float tangentAt(const std::vector<unsigned long>& times, const std::vector<float>& values, int index) {
+    int before = index > 0 ? index - 1 : index;
+    int after = index + 1 < static_cast<int>(times.size()) ? index + 1 : index;
+    if (times[after] <= times[before]) {
+        return 0.0f;
+    }
+    return (values[after] - values[before]) / (times[after] - times[before]);
+}
+
+void KeyframeAnimation::updateSlope(int segment) {
+    if (segment < 0 || segment + 1 >= static_cast<int>(times.size())) {
+        return;
+    }
+    
+    // Zero-length segments jump straight to their end value, and so do
+    // STEP segments once they reach it
+    unsigned long duration = times[segment + 1] > times[segment] ? times[segment + 1] - times[segment] : 0;
+    if (duration > 0 && getKeyFrameEasing(segment + 1) != STEP) {
+        slopes[segment] = (values[segment + 1] - values[segment]) / duration;
+    } else {
+        slopes[segment] = 0.0f;
+    }
+#if YBN_FIXED_POINT
+    // From the stored end values, rounded, so the segment lands on them
+    if (slopes[segment] != 0.0f) {
+        int64_t change = static_cast<int64_t>(fixedValues[segment + 1]) - fixedValues[segment];
+        int64_t scaled = change * 65536;
+        fixedSlopes[segment] = (scaled + (scaled >= 0 ? 1 : -1) * static_cast<int64_t>(duration / 2)) / static_cast<int64_t>(duration);
+    } else {
+        fixedSlopes[segment] = 0;
+    }
+#endif
+    if (!isCurved(segment)) {
+        return;
+    }
+    
+    // Cubic in u for the easing, scaled to this segment's change in value
+    SegmentCurve& curve = curves[segment];
+    float change = values[segment + 1] - values[segment];
+    switch (easings[segment + 1]) {
+        case EASE_IN:
+            curve.c1 = 0.0f;
+            curve.c2 = change;
+            curve.c3 = 0.0f;
+            break;
+        case EASE_OUT:
+            curve.c1 = 2.0f * change;
+            curve.c2 = -change;
+            curve.c3 = 0.0f;
+            break;
+        case EASE_IN_OUT:
+            curve.c1 = 0.0f;
+            curve.c2 = 3.0f * change;
+            curve.c3 = -2.0f * change;
+            break;
+        case BEZIER: {
+            float control1 = bezierControls[(segment + 1) * 2];
+            float control2 = bezierControls[(segment + 1) * 2 + 1];
+            curve.c1 = 3.0f * control1 * change;
+            curve.c2 = (3.0f * control2 - 6.0f * control1) * change;
+            curve.c3 = (3.0f * control1 - 3.0f * control2 + 1.0f) * change;
+            break;
+        }
+        default: {
+            // Cubic Hermite with tangents from the neighbouring keyframes
+            float tangent1 = tangentAt(times, values, segment) * duration;
+            float tangent2 = tangentAt(times, values, segment + 1) * duration;
+            curve.c1 = tangent1;
+            curve.c2 = 3.0f * change - 2.0f * tangent1 - tangent2;
+            curve.c3 = -2.0f * change + tangent1 + tangent2;
+            break;
+        }
+    }
+    curve.rate = duration > 0 ? 1.0f / duration : 0.0f;
+#if YBN_FIXED_POINT
+    curve.fixedC1 = toFixed(curve.c1);
+    curve.fixedC2 = toFixed(curve.c2);
+    curve.fixedC3 = toFixed(curve.c3);
+    curve.fixedRate = duration > 1 ? (1ULL << 32) / duration : (duration == 1 ? UINT32_MAX : 0);
+#endif
+}
+
+int KeyframeAnimation::getKeyframeCount() const {
+    return table != nullptr ? tableCount : times.size();
+}
+
+const String& KeyframeAnimation::getName() const {
+    return name;
+}
+
+uint32_t KeyframeAnimation::getNameHash() const {
+    return nameHash;
+}
+
+float KeyframeAnimation::getKeyFrameValue(int index) const {
+    if (index < 0 || index >= getKeyframeCount()) {
+        return 0.0;
+    }
+    return table != nullptr ? readKeyframeValue(&table[index]) : values[index];
+}
+
+unsigned long KeyframeAnimation::getKeyFrameTime(int index) const {
+    if (index < 0 || index >= getKeyframeCount()) {
+        return 0;
+    }
+    return table != nullptr ? readKeyframeTime(&table[index]) : times[index];
+}
+
+unsigned long KeyframeAnimation::getDuration() const {
+    return getKeyFrameTime(getKeyframeCount() - 1);
+}
+
+float KeyframeAnimation::segmentValue(int segment, float time) const {
+    // The segment's own formula, so a STEP segment holds its start value
+    // right up to its end
+    float startTime = getKeyFrameTime(segment);
+    float endTime = getKeyFrameTime(segment + 1);
+    float offset = constrain(time, startTime, endTime) - startTime;
+    float startValue = fromSample(getKeyFrameSample(segment));
+    if (table != nullptr) {
+        float length = endTime - startTime;
+        float endValue = fromSample(getKeyFrameSample(segment + 1));
+        return length > 0 ? startValue + (endValue - startValue) * offset / length : startValue;
+    }
+    
+    // Same coefficients as playback, so fixed-point rounding is included
+    if (isCurved(segment)) {
+        const SegmentCurve& curve = curves[segment];
+        float u = offset * curve.rate;
+#if YBN_FIXED_POINT
+        return startValue + u * (fromFixed(curve.fixedC1) + u * (fromFixed(curve.fixedC2) + u * fromFixed(curve.fixedC3)));
+#else
+        return startValue + u * (curve.c1 + u * (curve.c2 + u * curve.c3));
+#endif
+    }
+#if YBN_FIXED_POINT
+    return startValue + fixedSlopes[segment] / 4294967296.0f * offset;
+#else
+    return startValue + slopes[segment] * offset;
+#endif
+}
+
+bool KeyframeAnimation::segmentExit(int segment, float from, float to, float low, float high, float& exit) const {
+    // Split curves where they turn, so the value only rises or only falls
+    // between the points checked
+    float points[4] = {from, to, to, to};
+    int pointCount = 2;
+    if (isCurved(segment)) {
+        const SegmentCurve& curve = curves[segment];
+        float roots[2];
+        int rootCount = 0;
+        if (curve.c3 == 0.0f) {
+            if (curve.c2 != 0.0f) {
+                roots[rootCount++] = -curve.c1 / (2.0f * curve.c2);
+            }
+        } else {
+            float discriminant = curve.c2 * curve.c2 - 3.0f * curve.c3 * curve.c1;
+            if (discriminant >= 0.0f) {
+                float root = sqrtf(discriminant);
+                roots[rootCount++] = (-curve.c2 - root) / (3.0f * curve.c3);
+                roots[rootCount++] = (-curve.c2 + root) / (3.0f * curve.c3);
+            }
+        }
+        if (rootCount == 2 && (roots[0] > roots[1]) == (to > from)) {
+            float swap = roots[0];
+            roots[0] = roots[1];
+            roots[1] = swap;
+        }
+        pointCount = 1;
+        for (int i = 0; i < rootCount; i++) {
+            float time = getKeyFrameTime(segment) + roots[i] / curve.rate;
+            if ((time - from) * (to - time) > 0) {
+                points[pointCount++] = time;
+            }
+        }
+        points[pointCount++] = to;
+    }
+    
+    for (int i = 0; i + 1 < pointCount; i++) {
+        float start = points[i];
+        float end = points[i + 1];
+        float startValue = segmentValue(segment, start);
+        float endValue = segmentValue(segment, end);
+        if (endValue >= low && endValue < high) {
+            continue;
+        }
+        if (!isCurved(segment)) {
+            float bound = endValue < low ? low : high;
+            exit = start + (end - start) * (bound - startValue) / (endValue - startValue);
+            return true;
+        }
+        
+        // Bisect, keeping the inside end so the answer is never late
+        for (int step = 0; step < 24; step++) {
+            float middle = (start + end) * 0.5f;
+            float value = segmentValue(segment, middle);
+            if (value >= low && value < high) {
+                start = middle;
+            } else {
+                end = middle;
+            }
+        }
+        exit = start;
+        return true;
+    }
+    return false;
+}
+
+float KeyframeAnimation::timeUntilOutside(float from, float to, float low, float high) const {
+    int count = getKeyframeCount();
+    if (count == 0) {
+        return -1.0f;
+    }
+    float first = getKeyFrameTime(0);
+    float last = getDuration();
+    int segment = findSegment(from);
+    float value = count == 1 || from >= last
+        ? fromSample(getKeyFrameSample(count - 1))
+        : segmentValue(segment, from);
+    if (value < low || value >= high) {
+        return 0.0f;
+    }
+    if (count == 1) {
+        return -1.0f;
+    }
+    
+    // Walk the segments in the direction of play. Each one is checked
+    // from its own start, which catches jumps between segments
+    bool forward = to >= from;
+    float position = from;
+    while (forward ? position < to && position < last : position > to && position > first) {
+        segment = findSegment(position, segment);
+        while (!forward && segment > 0 && getKeyFrameTime(segment) >= position) {
+            segment--;
+        }
+        float segmentStart = getKeyFrameTime(segment);
+        float segmentEnd = getKeyFrameTime(segment + 1);
+        float end = forward ? (to < segmentEnd ? to : segmentEnd) : (to > segmentStart ? to : segmentStart);
+        float start = forward && position < segmentStart ? segmentStart : position;
+        
+        float exit;
+        value = segmentValue(segment, start);
+        if (value < low || value >= high) {
+            return fabsf(start - from);
+        }
+        if (segmentExit(segment, start, end, low, high, exit)) {
+            return fabsf(exit - from);
+        }
+        if (forward && end >= last) {
+            // The last keyframe's value holds from here on
+            value = fromSample(getKeyFrameSample(count - 1));
+            return value < low || value >= high ? end - from : -1.0f;
+        }
+        position = end;
+    }
+    return -1.0f;
+}
+
+bool KeyframeAnimation::hasSameKeyframes(const KeyframeAnimation& other) const {
+    if (bakeStep != other.bakeStep || bakeInterpolate != other.bakeInterpolate) {
+        return false;
+    }
+    if (table == nullptr && other.table == nullptr) {
+        return times == other.times && values == other.values && colors == other.colors &&
+               easings == other.easings && bezierControls == other.bezierControls;
+    }
+    if (!easings.empty() || !other.easings.empty()) {
+        return false;   // Tables are always linear
+    }
+    if (table == other.table && tableCount == other.tableCount) {
+        return true;
+    }
+    
+    // Mixed storage: compare keyframe by keyframe
+    int count = getKeyframeCount();
+    if (count != other.getKeyframeCount()) {
+        return false;
+    }
+    for (int i = 0; i < count; i++) {
+        if (getKeyFrameTime(i) != other.getKeyFrameTime(i) ||
+            getKeyFrameValue(i) != other.getKeyFrameValue(i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Keyframe value step between colour keyframes. Larger than 1 so the
+// per-ms slope keeps its precision in fixed point on long segments
+static const int COLOR_INDEX_STEP = 64;
+
+void KeyframeAnimation::addColorKeyFrame(uint32_t color, unsigned long time) {
+    if (table != nullptr) {
+        return;   // Tables are read-only
+    }
+    colors.push_back(color);
+    addKeyFrame(times.size() * COLOR_INDEX_STEP, time);
+}
+
+bool KeyframeAnimation::setKeyFrameColor(int index, uint32_t color) {
+    if (index < 0 || index >= static_cast<int>(colors.size())) {
+        return false;
+    }
+    colors[index] = color;
+    return true;
+}
+
+uint32_t KeyframeAnimation::getKeyFrameColor(int index) const {
+    if (index < 0 || index >= static_cast<int>(colors.size())) {
+        return 0;
+    }
+    return colors[index];
+}
+
+bool KeyframeAnimation::hasColors() const {
+    return !colors.empty();
+}
+
+uint32_t KeyframeAnimation::colorAt(sample_t index) const {
+    if (colors.empty()) {
+        return 0;
+    }
+    
+    // Keyframe index in 1/256 steps: the whole part picks the keyframe,
+    // the rest is the mixing weight
+#if YBN_FIXED_POINT
+    long steps = (static_cast<long>(index) + (1L << 13)) >> 14;
+#else
+    long steps = index * (256.0f / COLOR_INDEX_STEP) + 0.5f;
+#endif
+    int keyframe = steps >> 8;
+    uint16_t weight = steps & 0xFF;
+    int last = colors.size() - 1;
+    if (keyframe >= last) {
+        return colors[last];
+    }
+    if (keyframe < 0) {
+        return colors[0];
+    }
+    return lerpColor(colors[keyframe], colors[keyframe + 1], weight);
+}
+
+bool KeyframeAnimation::hasKeyframeTable() const {
+    return table != nullptr;
+}
+
+int KeyframeAnimation::findSegment(float time, int hint) const {
+    return findSegmentAt(time, hint);
+}
+
+// Shared by RAM arrays and keyframe tables; Times is anything that can
+// be indexed for a keyframe time
+template <typename Times, typename Time>
+static int searchSegment(const Times& times, int count, Time time, int hint) {
+    int lastSegment = count - 2;
+    if (lastSegment <= 0) {
+        return 0;
+    }
+    if (hint < 0 || hint > lastSegment) {
+        hint = 0;
+    }
+    
+    // Sequential playback usually stays in the hinted segment or moves
+    // one step, so check those before searching
+    int low;
+    int high;
+    if (times[hint] <= time) {
+        if (hint == lastSegment || time < times[hint + 1]) {
+            return hint;
+        }
+        if (hint + 1 == lastSegment || time < times[hint + 2]) {
+            return hint + 1;
+        }
+        low = hint + 2;
+        high = lastSegment;
+    } else {
+        if (hint == 0 || times[hint - 1] <= time) {
+            return hint > 0 ? hint - 1 : 0;
+        }
+        low = 0;
+        high = hint - 2;
+    }
+    
+    // Binary search for the last keyframe at or before time
+    while (low < high) {
+        int mid = low + (high - low + 1) / 2;
+        if (times[mid] <= time) {
+            low = mid;
+        } else {
+            high = mid - 1;
+        }
+    }
+    return low;
+}
+
+template <typename Time>
+int KeyframeAnimation::findSegmentAt(Time time, int hint) const {
+    if (table != nullptr) {
+        TableTimes tableTimes = {table};
+        return searchSegment(tableTimes, tableCount, time, hint);
+    }
+    return searchSegment(times.data(), times.size(), time, hint);
+}
+
+float KeyframeAnimation::valueAt(float time, int& segment) const {
+    if (table != nullptr) {
+        return tableValueAt(time, segment);
+    }
+    if (times.size() < 2) {
+        return values.empty() ? 0.0f : values[0];
+    }
+    
+    segment = findSegment(time, segment);
+    
+    // Clamp to the segment ends, then a single multiply-add
+    if (time >= times[segment + 1]) {
+        return values[segment + 1];
+    }
+    float offset = time - times[segment];
+    if (offset <= 0) {
+        return values[segment];
+    }
+    if (isCurved(segment)) {
+        const SegmentCurve& curve = curves[segment];
+        float u = offset * curve.rate;
+        return values[segment] + u * (curve.c1 + u * (curve.c2 + u * curve.c3));
+    }
+    return values[segment] + slopes[segment] * offset;
+}
+
+float KeyframeAnimation::tableValueAt(float time, int& segment) const {
+    if (tableCount < 2) {
+        return tableCount == 0 ? 0.0f : readKeyframeValue(&table[0]);
+    }
+    
+    segment = findSegment(time, segment);
+    
+    // Tables have no stored slopes, so interpolate with a divide
+    const Keyframe* start = &table[segment];
+    unsigned long startTime = readKeyframeTime(start);
+    unsigned long endTime = readKeyframeTime(start + 1);
+    if (time >= endTime) {
+        return readKeyframeValue(start + 1);
+    }
+    float offset = time - startTime;
+    float startValue = readKeyframeValue(start);
+    if (offset <= 0) {
+        return startValue;
+    }
+    return startValue + (readKeyframeValue(start + 1) - startValue) * offset / (endTime - startTime);
+}
+
+void KeyframeAnimation::sampleRange(float t0, float dt, int count, float* out) const {
+    int keyframeCount = getKeyframeCount();
+    float averageSegment = keyframeCount < 2 ? 0 : getDuration() / (keyframeCount - 1.0f);
+    if (keyframeCount < 2 || dt <= 0 || dt * 4 > averageSegment) {
+        // Nothing to interpolate, times not increasing, or too few samples
+        // per segment to repay the per-segment setup: one at a time
+        int segment = 0;
+        for (int i = 0; i < count; i++) {
+            out[i] = valueAt(t0 + i * dt, segment);
+        }
+        return;
+    }
+    
+    int segment = 0;
+    int i = 0;
+    while (i < count) {
+        segment = findSegment(t0 + i * dt, segment);
+        float startTime = getKeyFrameTime(segment);
+        float endTime = getKeyFrameTime(segment + 1);
+        float startValue = getKeyFrameValue(segment);
+        float length = endTime - startTime;
+        float slope = table != nullptr
+            ? (length > 0 ? (getKeyFrameValue(segment + 1) - startValue) / length : 0.0f)
+            : slopes[segment];
+        
+        // Samples before the segment's end; after the last segment the
+        // rest of the buffer holds the last value
+        bool lastSegment = segment + 2 >= keyframeCount;
+        float first = (endTime - t0) / dt;
+        int end = first < count ? static_cast<int>(ceilf(first)) : count;
+        if (end <= i) {
+            end = lastSegment ? i : i + 1;
+        }
+        
+        // Offsets are clamped to the segment, which also covers samples
+        // before the first keyframe
+        float offset0 = t0 - startTime;
+        if (isCurved(segment)) {
+            const SegmentCurve& curve = curves[segment];
+            for (int j = i; j < end; j++) {
+                float offset = offset0 + j * dt;
+                offset = offset < 0 ? 0 : offset;
+                offset = offset > length ? length : offset;
+                float u = offset * curve.rate;
+                out[j] = startValue + u * (curve.c1 + u * (curve.c2 + u * curve.c3));
+            }
+        } else {
+            for (int j = i; j < end; j++) {
+                float offset = offset0 + j * dt;
+                offset = offset < 0 ? 0 : offset;
+                offset = offset > length ? length : offset;
+                out[j] = startValue + slope * offset;
+            }
+        }
+        if (lastSegment) {
+            float endValue = getKeyFrameValue(segment + 1);
+            for (int j = end; j < count; j++) {
+                out[j] = endValue;
+            }
+            end = count;
+        }
+        i = end;
+    }
+}
+
+void KeyframeAnimation::sampleRange(float t0, float dt, int count, int* out) const {
+    // Evaluate in float blocks, then round
+    const int BLOCK = 32;
+    float block[BLOCK];
+    for (int i = 0; i < count; i += BLOCK) {
+        int n = count - i < BLOCK ? count - i : BLOCK;
+        sampleRange(t0 + i * dt, dt, n, block);
+        for (int j = 0; j < n; j++) {
+            out[i + j] = static_cast<int>(block[j] >= 0 ? block[j] + 0.5f : block[j] - 0.5f);
+        }
+    }
+}
+
+bool KeyframeAnimation::bake(unsigned long stepMs, int maxEntries, bool interpolate) {
+    unbake();
+    if (stepMs == 0 || maxEntries <= 0 || getKeyframeCount() < 2) {
+        return false;
+    }
+#if YBN_FIXED_POINT
+    // A power-of-two step turns the table index into a shift
+    uint8_t shift = 0;
+    while ((2UL << shift) <= stepMs && shift < 16) {
+        shift++;
+    }
+    stepMs = 1UL << shift;
+#endif
+    
+    // Enough values to cover the last keyframe, even when the step does
+    // not divide the duration evenly
+    unsigned long count = (getDuration() + stepMs - 1) / stepMs + 1;
+    if (count > static_cast<unsigned long>(maxEntries)) {
+        return false;
+    }
+    baked.resize(count);
+#if YBN_FIXED_POINT
+    const int BLOCK = 32;
+    float block[BLOCK];
+    for (unsigned long i = 0; i < count; i += BLOCK) {
+        int n = count - i < BLOCK ? count - i : BLOCK;
+        sampleRange(static_cast<float>(i * stepMs), stepMs, n, block);
+        for (int j = 0; j < n; j++) {
+            baked[i + j] = toFixed(block[j]);
+        }
+    }
+    bakeShift = shift;
+#else
+    sampleRange(0, stepMs, count, baked.data());
+    bakeRate = 1.0f / stepMs;
+#endif
+    bakeStep = stepMs;
+    bakeInterpolate = interpolate;
+    return true;
+}
+
+void KeyframeAnimation::unbake() {
+    // Swap rather than clear so the memory is released
+    std::vector<sample_t>().swap(baked);
+    bakeStep = 0;
+    bakeInterpolate = false;
+#if YBN_FIXED_POINT
+    bakeShift = 0;
+#else
+    bakeRate = 0;
+#endif
+}
+
+bool KeyframeAnimation::isBaked() const {
+    return bakeStep != 0;
+}
+
+unsigned long KeyframeAnimation::getBakedBytes() const {
+    return baked.capacity() * sizeof(sample_t);
+}
+
+sample_t KeyframeAnimation::bakedSampleAt(position_t time, int& segment) const {
+    // The keyframe cursor is still kept current for the status methods;
+    // on sequential playback that is a compare or two
+    unsigned long last = baked.size() - 1;
+#if YBN_FIXED_POINT
+    segment = findSegmentAt(static_cast<unsigned long>(time >> 8), segment);
+    if (!bakeInterpolate) {
+        unsigned long index = (time + (1UL << (7 + bakeShift))) >> (8 + bakeShift);
+        return baked[index < last ? index : last];
+    }
+    unsigned long index = time >> (8 + bakeShift);
+    if (index >= last) {
+        return baked[last];
+    }
+    
+    // Position between the two values in 1/256 steps
+    fixed_t fraction = (time >> bakeShift) & 0xFF;
+    return baked[index] + ((baked[index + 1] - baked[index]) >> 8) * fraction;
+#else
+    segment = findSegmentAt(time, segment);
+    float steps = time * bakeRate;
+    if (steps <= 0) {
+        return baked[0];
+    }
+    if (!bakeInterpolate) {
+        unsigned long index = static_cast<unsigned long>(steps + 0.5f);
+        return baked[index < last ? index : last];
+    }
+    unsigned long index = static_cast<unsigned long>(steps);
+    if (index >= last) {
+        return baked[last];
+    }
+    return baked[index] + (baked[index + 1] - baked[index]) * (steps - index);
+#endif
+}
+
+#if YBN_FIXED_POINT
+sample_t KeyframeAnimation::sampleAt(position_t time, int& segment) const {
+    if (bakeStep != 0) {
+        return bakedSampleAt(time, segment);
+    }
+    if (table != nullptr) {
+        return tableSampleAt(time, segment);
+    }
+    if (times.size() < 2) {
+        return fixedValues.empty() ? 0 : fixedValues[0];
+    }
+    
+    // Keyframe times are whole ms, so the search only needs those
+    segment = findSegmentAt(static_cast<unsigned long>(time >> 8), segment);
+    
+    position_t segmentStart = static_cast<position_t>(times[segment]) << 8;
+    if (time >= static_cast<position_t>(times[segment + 1]) << 8) {
+        return fixedValues[segment + 1];
+    }
+    if (time <= segmentStart) {
+        return fixedValues[segment];
+    }
+    if (isCurved(segment)) {
+        // u in Q16.16, then Horner's rule on the segment's cubic
+        const SegmentCurve& curve = curves[segment];
+        sample_t u = (static_cast<uint64_t>(time - segmentStart) * curve.fixedRate) >> 24;
+        sample_t sum = curve.fixedC2 + mulSample(curve.fixedC3, u);
+        sum = curve.fixedC1 + mulSample(sum, u);
+        return fixedValues[segment] + mulSample(sum, u);
+    }
+    // Q32.32 per ms by Q24.8 ms: under 2^56 for any segment within range
+    int64_t change = fixedSlopes[segment] * (time - segmentStart);
+    return fixedValues[segment] + static_cast<fixed_t>(change >> 24);
+}
+
+sample_t KeyframeAnimation::tableSampleAt(position_t time, int& segment) const {
+    if (tableCount < 2) {
+        return tableCount == 0 ? 0 : toFixed(readKeyframeValue(&table[0]));
+    }
+    
+    segment = findSegmentAt(static_cast<unsigned long>(time >> 8), segment);
+    
+    const Keyframe* start = &table[segment];
+    position_t segmentStart = static_cast<position_t>(readKeyframeTime(start)) << 8;
+    position_t segmentEnd = static_cast<position_t>(readKeyframeTime(start + 1)) << 8;
+    if (time >= segmentEnd) {
+        return toFixed(readKeyframeValue(start + 1));
+    }
+    fixed_t startValue = toFixed(readKeyframeValue(start));
+    if (time <= segmentStart) {
+        return startValue;
+    }
+    int64_t change = static_cast<int64_t>(toFixed(readKeyframeValue(start + 1)) - startValue) *
+                     (time - segmentStart) / (segmentEnd - segmentStart);
+    return startValue + static_cast<fixed_t>(change);
+}
+
+sample_t KeyframeAnimation::getKeyFrameSample(int index) const {
+    if (table != nullptr) {
+        return index < 0 || index >= tableCount ? 0 : toFixed(readKeyframeValue(&table[index]));
+    }
+    if (index < 0 || index >= static_cast<int>(fixedValues.size())) {
+        return 0;
+    }
+    return fixedValues[index];
+}
+#else
+sample_t KeyframeAnimation::sampleAt(position_t time, int& segment) const {
+    if (bakeStep != 0) {
+        return bakedSampleAt(time, segment);
+    }
+    return valueAt(time, segment);
+}
+
+sample_t KeyframeAnimation::getKeyFrameSample(int index) const {
+    return getKeyFrameValue(index);
+}
+#endif
+
+//======================================================================
+// AnimationLibrary Implementation
+//======================================================================
+
+uint32_t hashAnimationName(const String& name) {
+    // 32-bit FNV-1a
+    uint32_t hash = 2166136261UL;
+    for (const char* c = name.c_str(); *c != '\0'; c++) {
+        hash = (hash ^ static_cast<uint8_t>(*c)) * 16777619UL;
+    }
+    return hash;
 }
 
-void KeyframeAnimation::addKeyFrame(float value, unsigned long time) {
-    Keyframe newFrame = {value, time};
-    keyframes.push_back(newFrame);
+AnimationLibrary::AnimationLibrary() {
 }
 
-bool KeyframeAnimation::setKeyFrameValue(int index, float newValue) {
-    if (index < 0 || index >= keyframes.size()) {
-        return false;
+AnimationLibrary::~AnimationLibrary() {
+    for (auto* entry : entries) {
+        delete entry;
     }
-    keyframes[index].value = newValue;
-    return true;
 }
 
-bool KeyframeAnimation::setKeyFrameTime(int index, unsigned long newTime) {
-    if (index < 0 || index >= keyframes.size()) {
-        return false;
+void AnimationLibrary::reserve(int animationCount) {
+    entries.reserve(animationCount);
+}
+
+AnimationId AnimationLibrary::add(const KeyframeAnimation& animation) {
+    // Setup-time scan: reuse an identical entry rather than copying again
+    for (size_t i = 0; i < entries.size(); i++) {
+        const KeyframeAnimation* entry = entries[i];
+        if (entry->getNameHash() == animation.getNameHash() &&
+            entry->getName() == animation.getName() &&
+            entry->hasSameKeyframes(animation)) {
+            return i;
+        }
     }
-    keyframes[index].time = newTime;
-    return true;
+    
+    // Each entry has its own allocation so its address never changes
+    entries.push_back(new KeyframeAnimation(animation));
+    return entries.size() - 1;
 }
 
-int KeyframeAnimation::getKeyframeCount() const {
-    return keyframes.size();
+const KeyframeAnimation* AnimationLibrary::get(AnimationId id) const {
+    if (id < 0 || id >= static_cast<AnimationId>(entries.size())) {
+        return nullptr;
+    }
+    return entries[id];
 }
 
-const String& KeyframeAnimation::getName() const {
-    return name;
+AnimationId AnimationLibrary::find(const String& name) const {
+    uint32_t hash = hashAnimationName(name);
+    for (int i = entries.size() - 1; i >= 0; i--) {
+        if (entries[i]->getNameHash() == hash && entries[i]->getName() == name) {
+            return i;
+        }
+    }
+    return NO_ANIMATION;
 }
 
-float KeyframeAnimation::getKeyFrameValue(int index) const {
-    if (index < 0 || index >= keyframes.size()) {
-        return 0.0;
+int AnimationLibrary::getCount() const {
+    return entries.size();
+}
+
+long AnimationLibrary::getKeyframeCount() const {
+    long total = 0;
+    for (const auto* entry : entries) {
+        if (!entry->hasKeyframeTable()) {
+            total += entry->getKeyframeCount();
+        }
     }
-    return keyframes[index].value;
+    return total;
 }
 
-unsigned long KeyframeAnimation::getKeyFrameTime(int index) const {
-    if (index < 0 || index >= keyframes.size()) {
+unsigned long AnimationLibrary::getBakedBytes() const {
+    unsigned long total = 0;
+    for (const auto* entry : entries) {
+        total += entry->getBakedBytes();
+    }
+    return total;
+}
+
+AnimationLibrary& getAnimationLibrary() {
+    static AnimationLibrary library;
+    return library;
+}
+
+//======================================================================
+// Output Policy Implementation
+//======================================================================
+
+ServoOutput::ServoOutput(Servo* servo, int minAngle, int maxAngle)
+    : servo(servo),
+      minAngle(minAngle),
+      maxAngle(maxAngle) {
+}
+
+LEDOutput::LEDOutput(int pin, LEDMode mode)
+    : pin(pin),
+      mode(mode),
+      threshold(0.5f) {
+}
+
+void LEDOutput::begin() {
+    pinMode(pin, OUTPUT);
+    digitalWrite(pin, LOW);
+}
+
+void LEDOutput::setMode(LEDMode newMode) {
+    mode = newMode;
+}
+
+void LEDOutput::setThreshold(float newThreshold) {
+    threshold = constrain(newThreshold, 0.0f, 1.0f);
+}
+
+//======================================================================
+// OutputSink Implementation
+//======================================================================
+
+OutputSink::OutputSink(int channelCount)
+    : levels(channelCount, 0),
+      firstChanged(-1),
+      lastChanged(-1),
+      transactionCount(0) {
+}
+
+uint16_t OutputSink::get(int channel) const {
+    if (channel < 0 || channel >= static_cast<int>(levels.size())) {
         return 0;
     }
-    return keyframes[index].time;
+    return levels[channel];
+}
+
+bool OutputSink::flush() {
+    if (firstChanged < 0) {
+        return false;
+    }
+    int first = firstChanged;
+    int count = lastChanged - firstChanged + 1;
+    firstChanged = -1;
+    lastChanged = -1;
+    send(first, count, &levels[first]);
+    transactionCount++;
+    return true;
+}
+
+void OutputSink::resendAll() {
+    if (!levels.empty()) {
+        firstChanged = 0;
+        lastChanged = levels.size() - 1;
+    }
+}
+
+int OutputSink::getChannelCount() const {
+    return levels.size();
+}
+
+unsigned long OutputSink::getTransactionCount() const {
+    return transactionCount;
+}
+
+SinkOutput::SinkOutput(OutputSink* sink, int channel)
+    : sink(sink),
+      channel(channel) {
+}
+
+OutputSink& SinkOutput::getSink() const {
+    return *sink;
+}
+
+int SinkOutput::getChannel() const {
+    return channel;
 }
 
 //======================================================================
-// ServoNotifier Implementation
+// NotifierBase Implementation
 //======================================================================
 
-// New constructor that doesn't require a Servo object
-ServoNotifier::ServoNotifier(int minAngle, int maxAngle) 
-    : servo(nullptr), 
-      minAngle(minAngle), 
-      maxAngle(maxAngle),
-      currentAnimation(nullptr),
-      targetAnimation(nullptr),
-      currentMode(PLAY_ONCE),
-      currentState(IDLE),
-      globalSpeed(1.0),
-      startTime(0),
-      pauseTime(0),
-      totalPausedTime(0),
-      currentKeyframeIndex(0),
-      nextKeyframeIndex(0),
-      currentValue(0.0),
-      isReversing(false),
-      isPlayingBackward(false),
-      valueScale(1.0),
-      valueOffset(0.0),
-      minValue(-INFINITY),
-      maxValue(INFINITY),
-      isBlending(false),
-      blendStartTime(0),
-      blendDuration(0),
-      startValue(0.0) {
+// Returned by reference when there is no animation to name
+static const String noAnimationName;
+
+// Position within one period of a repeating timeline
+static position_t wrapPosition(position_t position, position_t period) {
+#if YBN_FIXED_POINT
+    return position % period;
+#else
+    return fmodf(position, period);
+#endif
+}
+
+// Folds position into one pass of duration, however many passes it
+// covers. Returns true if that is an odd number, which turns a boomerang
+static unsigned long foldPasses(position_t& position, position_t duration) {
+#if YBN_FIXED_POINT
+    position_t passes = position / duration;
+    position -= passes * duration;
+    return passes;
+#else
+    float passes = floorf(position / duration);
+    position = fmodf(position, duration);   // Exact, unlike subtracting
+    return static_cast<unsigned long>(passes);
+#endif
+}
+
+// (a * b) % m without overflow, for a < m < 2^63
+static uint64_t mulMod(uint64_t a, uint32_t b, uint64_t m) {
+    uint64_t result = 0;
+    while (b != 0) {
+        if (b & 1) {
+            result += a;
+            if (result >= m) {
+                result -= m;
+            }
+        }
+        a <<= 1;
+        if (a >= m) {
+            a -= m;
+        }
+        b >>= 1;
+    }
+    return result;
+}
+
+// Wall time in seconds and ms to animation ms at speed, rounded and
+// folded into cycle ms (0: not folded, for times that fit). speed is
+// a 24-bit mantissa over a power of two, so folding by cycle times that
+// power before dividing by it is exact, however long the time
+static unsigned long foldWallTime(unsigned long seconds, int ms, float speed, unsigned long cycle) {
+    if (cycle == 0) {
+        cycle = 0xFFFFFFFFUL;
+    }
+    int exponent;
+    uint32_t mantissa = ldexp(frexp(speed, &exponent), 24);
+    int shift = 24 - exponent;   // speed = mantissa / 2^shift
+    if (shift < 1 || shift > 62 || cycle >= (static_cast<uint64_t>(1) << (63 - shift))) {
+        // Extreme speeds: as near as double (or float) gets
+        return fmod((seconds * 1000.0 + ms) * speed + 0.5, static_cast<double>(cycle));
+    }
+    uint64_t modulus = static_cast<uint64_t>(cycle) << shift;
+    uint64_t wallMs = (static_cast<uint64_t>(seconds) * 1000 + ms) % modulus;
+    uint64_t scaled = mulMod(wallMs, mantissa, modulus);
+    scaled = (scaled + (static_cast<uint64_t>(1) << (shift - 1))) % modulus;
+    return scaled >> shift;
 }
 
-ServoNotifier::ServoNotifier(Servo& servoRef, int minAngle, int maxAngle) 
-    : servo(&servoRef), 
-      minAngle(minAngle), 
-      maxAngle(maxAngle),
+NotifierBase::NotifierBase()
+    : playsColors(false),
       currentAnimation(nullptr),
       targetAnimation(nullptr),
+      wallClock(nullptr),
+      scheduledAt(0),
+      startsLater(false),
       currentMode(PLAY_ONCE),
       currentState(IDLE),
       globalSpeed(1.0),
+      timeSource(),
+      membership(),
+      tickScale(0),
+#if YBN_FIXED_POINT
+      tickShift(0),
+#else
+      tickScaleLow(0),
+#endif
       startTime(0),
+      phase(0),
+      phaseFraction(0),
       pauseTime(0),
       totalPausedTime(0),
       currentKeyframeIndex(0),
       nextKeyframeIndex(0),
-      currentValue(0.0),
+      currentValue(0),
       isReversing(false),
       isPlayingBackward(false),
-      valueScale(1.0),
-      valueOffset(0.0),
-      minValue(-INFINITY),
-      maxValue(INFINITY),
+      valueScale(toSample(1.0f)),
+      valueOffset(0),
+      minValue(SAMPLE_MIN),
+      maxValue(SAMPLE_MAX),
       isBlending(false),
       blendStartTime(0),
       blendDuration(0),
-      startValue(0.0) {
-}
-
-void ServoNotifier::addAnimation(const KeyframeAnimation& animation) {
-    // Only add if it has keyframes and isn't already in our list
-    if (animation.getKeyframeCount() == 0) {
-        return;
+      targetMode(PLAY_ONCE),
+      targetKeyframeIndex(0),
+      outgoingValue(0),
+      targetValue(0),
+      blendWeight(0),
+      heldColor(0),
+      holdOutgoing(false),
+      changeValue(INT_MIN),
+      writtenLevel(LONG_MIN),
+      skippedWrites(0),
+      eventCallback(nullptr),
+      eventContext(nullptr),
+      eventMask(0),
+      eventFlags(0),
+      eventSerial(0),
+      eventsPending(false),
+      eventFromReversing(false),
+      eventFromKeyframe(0),
+      wrapPasses(0) {
+}
+
+NotifierBase::~NotifierBase() {
+    if (membership.group != nullptr) {
+        membership.group->leave(membership.slot);
+    }
+}
+
+AnimationId NotifierBase::addAnimation(const KeyframeAnimation& animation) {
+    // Only add if we can play it and it isn't already in our list
+    if (!canPlay(&animation)) {
+        return NO_ANIMATION;
     }
     
     // Check for duplicate name
-    for (const auto& anim : animations) {
-        if (anim.getName() == animation.getName()) {
-            return; // Skip duplicates
-        }
+    AnimationId existing = getAnimationId(animation.getName());
+    if (existing != NO_ANIMATION) {
+        return existing; // Skip duplicates
     }
     
-    animations.push_back(animation);
+    AnimationId id = getAnimationLibrary().add(animation);
+    animations.push_back(id);
+    return id;
+}
+
+AnimationId NotifierBase::getAnimationId(const String& name) const {
+    // Setup-time lookup: the hash rules out nearly every entry without
+    // comparing strings
+    const AnimationLibrary& library = getAnimationLibrary();
+    uint32_t hash = hashAnimationName(name);
+    for (AnimationId id : animations) {
+        const KeyframeAnimation* anim = library.get(id);
+        if (anim->getNameHash() == hash && anim->getName() == name) {
+            return id;
+        }
+    }
+    return NO_ANIMATION;
+}
+
+bool NotifierBase::canPlay(const KeyframeAnimation* animation) const {
+    // Colour animations hold keyframe indexes as values, which only an
+    // RGBNotifier turns into output
+    return animation != nullptr && animation->getKeyframeCount() > 0 && animation->hasColors() == playsColors;
+}
+
+const KeyframeAnimation* NotifierBase::resolveAnimation(const KeyframeAnimation& animation) {
+    // Use our entry with this name, adding the animation if there is none
+    return getAnimationLibrary().get(addAnimation(animation));
 }
 
-void ServoNotifier::playAnimation(const KeyframeAnimation& animation, PlayMode mode) {
-    if (animation.getKeyframeCount() < 1) {
+void NotifierBase::playAnimation(const KeyframeAnimation& animation, PlayMode mode) {
+    if (!canPlay(&animation)) {
         return;
     }
     
@@ -138,30 +1460,22 @@ void ServoNotifier::playAnimation(const KeyframeAnimation& animation, PlayMode m
     stop();
     
     // Set up new animation
-    for (const auto& anim : animations) {
-        if (anim.getName() == animation.getName()) {
-            currentAnimation = const_cast<KeyframeAnimation*>(&anim);
-            break;
-        }
-    }
-    
-    // If not in our collection, use the provided one directly
-    if (currentAnimation == nullptr) {
-        addAnimation(animation);
-        for (auto& anim : animations) {
-            if (anim.getName() == animation.getName()) {
-                currentAnimation = &anim;
-                break;
-            }
-        }
-    }
+    startAnimation(resolveAnimation(animation), mode, clock().now());
+}
+
+void NotifierBase::startAnimation(const KeyframeAnimation* animation, PlayMode mode, unsigned long now) {
+    currentAnimation = animation;
+    targetAnimation = nullptr;
+    isBlending = false;
+    holdOutgoing = false;
+    startsLater = false;
+    eventSerial++;
     
     // Initialize playback state
     currentMode = mode;
     isReversing = false;
     isPlayingBackward = false;
     currentKeyframeIndex = 0;
-    nextKeyframeIndex = 1;
     
     if (currentAnimation->getKeyframeCount() > 1) {
         nextKeyframeIndex = 1;
@@ -170,294 +1484,684 @@ void ServoNotifier::playAnimation(const KeyframeAnimation& animation, PlayMode m
     }
     
     // Start timing
-    startTime = millis();
+    startTime = now;
+    phase = 0;
+    phaseFraction = 0;
     totalPausedTime = 0;
+    updateTickScale();
     
     // Initial value
-    currentValue = currentAnimation->getKeyFrameValue(0);
+    currentValue = currentAnimation->getKeyFrameSample(0);
     
     // Set state
     currentState = PLAYING;
+    if (membership.group != nullptr) {
+        membership.group->activate(membership.slot);
+    }
 }
 
-bool ServoNotifier::playAnimation(const String& name, PlayMode mode) {
+bool NotifierBase::playAnimation(const String& name, PlayMode mode) {
     // Find animation by name
-    for (auto& anim : animations) {
-        if (anim.getName() == name) {
-            playAnimation(anim, mode);
-            return true;
+    return playAnimation(getAnimationId(name), mode);
+}
+
+bool NotifierBase::playAnimation(AnimationId id, PlayMode mode) {
+    const KeyframeAnimation* animation = getAnimationLibrary().get(id);
+    if (!canPlay(animation)) {
+        return false;
+    }
+    
+    stop();
+    startAnimation(animation, mode, clock().now());
+    return true;
+}
+
+bool NotifierBase::playAt(const KeyframeAnimation& animation, const WallClock& clock, unsigned long epochSeconds,
+                          PlayMode mode) {
+    if (!canPlay(&animation)) {
+        return false;
+    }
+    return scheduleAnimation(resolveAnimation(animation), clock, epochSeconds, mode);
+}
+
+bool NotifierBase::playAt(const String& name, const WallClock& clock, unsigned long epochSeconds,
+                          PlayMode mode) {
+    return playAt(getAnimationId(name), clock, epochSeconds, mode);
+}
+
+bool NotifierBase::playAt(AnimationId id, const WallClock& clock, unsigned long epochSeconds,
+                          PlayMode mode) {
+    const KeyframeAnimation* animation = getAnimationLibrary().get(id);
+    if (!canPlay(animation)) {
+        return false;
+    }
+    return scheduleAnimation(animation, clock, epochSeconds, mode);
+}
+
+bool NotifierBase::scheduleAnimation(const KeyframeAnimation* animation, const WallClock& clock,
+                                     unsigned long epochSeconds, PlayMode mode) {
+    stop();
+    startAnimation(animation, mode, this->clock().now());
+    wallClock = &clock;
+    scheduledAt = epochSeconds;
+    return syncToWallClock();
+}
+
+bool NotifierBase::syncToWallClock() {
+    if (wallClock == nullptr || currentAnimation == nullptr || currentState == IDLE) {
+        return false;
+    }
+    int ms;
+    long seconds = wallClock->secondsSince(scheduledAt, ms);
+    if (seconds >= 0) {
+        // Wall time to animation time, folded into a loop's cycle (two
+        // passes for a boomerang, so it turns the same way) before it
+        // can overflow, however long ago the start was
+        unsigned long duration = currentAnimation->getDuration();
+        if (currentMode == PLAY_ONCE) {
+            if (seconds * globalSpeed > duration / 1000.0f + 1) {
+                return seek(duration);
+            }
+            return seek(foldWallTime(seconds, ms, globalSpeed, 0));
         }
+        unsigned long cycle = currentMode == PLAY_BOOMERANG ? 2 * duration : duration;
+        return seek(foldWallTime(seconds, ms, globalSpeed, cycle));
     }
-    return false;
+    
+    // Not yet: hold the first keyframe, then start on time. A start
+    // further off than the clock can count is held until a later sync
+    if (isBlending && targetAnimation != nullptr) {
+        promoteTarget();
+    }
+    jumpTo(0, false);
+    const unsigned long MOST_TICKS = 0x3FFFFFFFUL;
+    unsigned long ticksPerMs = clock().ticksPerMs;
+    unsigned long waitSeconds = static_cast<unsigned long>(-seconds);
+    startTime += waitSeconds <= MOST_TICKS / ticksPerMs / 1000 ? (waitSeconds * 1000 - ms) * ticksPerMs : MOST_TICKS;
+    startsLater = true;
+    return true;
 }
 
-void ServoNotifier::crossfadeTo(const KeyframeAnimation& animation, unsigned long blendTime, PlayMode mode) {
-    if (animation.getKeyframeCount() < 1 || currentState == IDLE) {
+void NotifierBase::crossfadeTo(const KeyframeAnimation& animation, unsigned long blendTime, PlayMode mode) {
+    if (!canPlay(&animation) || currentState == IDLE) {
         // If no animation is playing, just start the new one
         playAnimation(animation, mode);
         return;
     }
     
-    // Save current value for blending
-    startValue = currentValue;
+    // Find the target animation in our collection, adding it if needed
+    beginCrossfade(resolveAnimation(animation), blendTime, mode, clock().now());
+}
+
+bool NotifierBase::crossfadeTo(const String& name, unsigned long blendTime, PlayMode mode) {
+    // Find animation by name
+    return crossfadeTo(getAnimationId(name), blendTime, mode);
+}
+
+bool NotifierBase::crossfadeTo(AnimationId id, unsigned long blendTime, PlayMode mode) {
+    const KeyframeAnimation* animation = getAnimationLibrary().get(id);
+    if (!canPlay(animation)) {
+        return false;
+    }
     
-    // Find the target animation in our collection
-    targetAnimation = nullptr;
-    for (auto& anim : animations) {
-        if (anim.getName() == animation.getName()) {
-            targetAnimation = &anim;
-            break;
-        }
+    if (currentState == IDLE) {
+        // If no animation is playing, just start the new one
+        return playAnimation(id, mode);
     }
     
-    // If not in our collection, add it
-    if (targetAnimation == nullptr) {
-        addAnimation(animation);
-        for (auto& anim : animations) {
-            if (anim.getName() == animation.getName()) {
-                targetAnimation = &anim;
-                break;
-            }
+    beginCrossfade(animation, blendTime, mode, clock().now());
+    return true;
+}
+
+void NotifierBase::beginCrossfade(const KeyframeAnimation* target, unsigned long blendTime, PlayMode mode,
+                                  unsigned long startedAt) {
+    unsigned long now = clock().now();
+    wallClock = nullptr;   // The schedule was for the animation fading out
+    eventSerial++;
+    bool wasBlending = isBlending && targetAnimation != nullptr;
+    sample_t mixedValue = currentValue;
+    uint32_t mixedColor = wasBlending && currentAnimation->hasColors() ? blendColor() : 0;
+    if (wasBlending) {
+        // Fading again mid-blend: the animation being faded to takes
+        // over underneath, but the new fade starts from the mix being
+        // output, held where it is
+        promoteTarget();
+        if (currentState == PLAYING) {
+            calculateCurrentValue(now);
+            currentState = PLAYING;
         }
     }
     
+    // The target starts playing now, mixed in as the blend goes on
+    targetAnimation = target;
+    targetMode = mode;
+    targetKeyframeIndex = 0;
+    outgoingValue = mixedValue;
+    holdOutgoing = wasBlending;
+    heldColor = mixedColor;
+    targetValue = target->getKeyFrameSample(0);
+    blendWeight = 0;
+    
     // Set up blending
     isBlending = true;
-    blendStartTime = millis();
-    blendDuration = blendTime;
+    blendStartTime = startedAt;
+    blendDuration = blendTime * clock().ticksPerMs;
+    
+    if (currentState == COMPLETED) {
+        // A finished animation holds its last value while the target
+        // fades in over it
+        currentState = PLAYING;
+        if (membership.group != nullptr) {
+            membership.group->activate(membership.slot);
+        }
+    }
 }
 
-bool ServoNotifier::crossfadeTo(const String& name, unsigned long blendTime, PlayMode mode) {
-    // Find animation by name
-    for (auto& anim : animations) {
-        if (anim.getName() == name) {
-            crossfadeTo(anim, blendTime, mode);
-            return true;
-        }
+void NotifierBase::startCue(const KeyframeAnimation* animation, PlayMode mode, unsigned long blendTime,
+                            unsigned long startedAt) {
+    // As playAnimation() or crossfadeTo(), but timed from startedAt, so
+    // a cue fired late plays as if it had fired on time. A blend from a
+    // finished animation fades from where it came to rest
+    if (blendTime == 0 || currentState == IDLE) {
+        stop();
+        startAnimation(animation, mode, startedAt);
+    } else {
+        beginCrossfade(animation, blendTime, mode, startedAt);
     }
-    return false;
 }
 
-float ServoNotifier::interpolateValue(float startVal, float endVal, float t) {
+void NotifierBase::promoteTarget() {
+    // The target has played since the blend started, so it takes over
+    // from there, with its cursor where the blend left it
+    AnimationState state = currentState;
+    int segment = targetKeyframeIndex;
+    startAnimation(targetAnimation, targetMode, blendStartTime);
+    currentState = state;
+    currentKeyframeIndex = segment;
+    nextKeyframeIndex = segment + 1 < currentAnimation->getKeyframeCount() ? segment + 1 : segment;
+}
+
+uint32_t NotifierBase::blendColor() const {
+    // Mix the colours of both animations as they play, or of the held
+    // mix a second crossfade started from
+    uint32_t from = holdOutgoing ? heldColor : currentAnimation->colorAt(outgoingValue);
+    uint32_t to = targetAnimation->colorAt(targetValue);
+#if YBN_FIXED_POINT
+    uint16_t weight = (blendWeight + 0x80) >> 8;
+#else
+    uint16_t weight = blendWeight * 256.0f + 0.5f;
+#endif
+    return lerpColor(from, to, weight);
+}
+
+position_t NotifierBase::targetPosition(unsigned long elapsed, bool& reversing) const {
+    // Position on the target's timeline; it plays in its own mode from
+    // the start of the blend
+    position_t position = toPosition(elapsed);
+    position_t duration = targetAnimation->getDuration();
+#if YBN_FIXED_POINT
+    duration <<= 8;
+#endif
+    reversing = false;
+    if (position < duration) {
+        return position;
+    }
+    if (targetMode == PLAY_ONCE || duration == 0) {
+        return duration;
+    }
+    if (targetMode == PLAY_LOOP) {
+        return wrapPosition(position, duration);
+    }
+    
+    // Boomerang: forward, then back over the same timeline
+    position = wrapPosition(position, duration * 2);
+    if (position >= duration) {
+        reversing = true;
+        position = duration * 2 - position;
+    }
+    return position;
+}
+
+sample_t NotifierBase::interpolateValue(sample_t startVal, sample_t endVal, sample_t t) {
     // Linear interpolation
-    return startVal + (endVal - startVal) * t;
+    return startVal + mulSample(endVal - startVal, t);
 }
 
-float ServoNotifier::calculateCurrentValue() {
+sample_t NotifierBase::calculateCurrentValue(unsigned long now) {
     if (currentAnimation == nullptr || currentAnimation->getKeyframeCount() < 1) {
         return currentValue;
     }
     
     // Get elapsed time, accounting for pauses
-    unsigned long currentTime = millis();
-    unsigned long effectiveTime = currentTime - startTime - totalPausedTime;
+    unsigned long effectiveTime = now - startTime - totalPausedTime;
     
     // Handle single keyframe case
     if (currentAnimation->getKeyframeCount() == 1) {
-        currentValue = currentAnimation->getKeyFrameValue(0);
+        currentValue = currentAnimation->getKeyFrameSample(0);
         return currentValue;
     }
     
-    // Get animation duration (scaled by globalSpeed)
-    unsigned long animationDuration = currentAnimation->getKeyFrameTime(
-        currentAnimation->getKeyframeCount() - 1
-    ) / globalSpeed;
+    // Position on the animation's own timeline, carrying on from the
+    // last wrap
+#if YBN_FIXED_POINT
+    uint64_t fine = static_cast<uint64_t>(effectiveTime) * tickScale + phaseFraction;
+    position_t position = phase + static_cast<position_t>(fine >> tickShift);
+#else
+    float ticks = effectiveTime;
+    float scaled = ticks * tickScale;
+    position_t position = phase + scaled;
+#endif
+    position_t animationDuration = currentAnimation->getDuration();
+#if YBN_FIXED_POINT
+    animationDuration <<= 8;
+#endif
     
     // Handle animation completion
-    if (effectiveTime >= animationDuration) {
+    if (position >= animationDuration) {
         if (currentMode == PLAY_ONCE) {
             // Animation complete
-            currentValue = currentAnimation->getKeyFrameValue(
+            currentValue = currentAnimation->getKeyFrameSample(
                 currentAnimation->getKeyframeCount() - 1
             );
             currentState = COMPLETED;
             return currentValue;
-        } else if (currentMode == PLAY_LOOP) {
-            // Loop back to start
-            startTime = currentTime - totalPausedTime;
-            effectiveTime = 0;
+        }
+        
+        // Wrap by modulo, keeping the overshoot however many passes this
+        // frame covered, so repeats never drift. Time restarts at this
+        // frame with the overshoot as its phase
+        unsigned long passes = 1;
+        if (animationDuration > 0) {
+            passes = foldPasses(position, animationDuration);
+        } else {
+            position = 0;
+        }
+        wrapPasses += passes;
+        bool turned = passes & 1;
+        startTime = now - totalPausedTime;
+#if YBN_FIXED_POINT
+        phase = position;
+        phaseFraction = fine & ((static_cast<uint64_t>(1) << tickShift) - 1);
+#else
+        // Add back what rounding dropped from this pass's position, and
+        // carry what phase cannot hold, so hours of wraps cannot drift
+        float unwrapped = phase + scaled;
+        float scaledPart = unwrapped - phase;
+        float dropped = (phase - (unwrapped - scaledPart)) + (scaled - scaledPart) +
+                        fmaf(ticks, tickScale, -scaled) +
+                        static_cast<long>(effectiveTime - static_cast<unsigned long>(ticks)) * tickScale +
+                        ticks * tickScaleLow + phaseFraction;
+        phase = position + dropped;
+        phaseFraction = dropped - (phase - position);
+        if (phase < 0) {
+            phase = 0;
+        }
+#endif
+        if (currentMode == PLAY_BOOMERANG && turned) {
+            isReversing = !isReversing;
+        }
+        if (!isReversing) {
             currentKeyframeIndex = 0;
             nextKeyframeIndex = 1;
-        } else if (currentMode == PLAY_BOOMERANG) {
-            if (!isReversing) {
-                // Switch to reverse playback
-                isReversing = true;
-                startTime = currentTime - totalPausedTime;
-                effectiveTime = 0;
-                currentKeyframeIndex = currentAnimation->getKeyframeCount() - 1;
-                nextKeyframeIndex = currentAnimation->getKeyframeCount() - 2;
-            } else {
-                // Switch to forward playback
-                isReversing = false;
-                startTime = currentTime - totalPausedTime;
-                effectiveTime = 0;
-                currentKeyframeIndex = 0;
-                nextKeyframeIndex = 1;
-            }
+        } else {
+            currentKeyframeIndex = currentAnimation->getKeyframeCount() - 1;
+            nextKeyframeIndex = currentAnimation->getKeyframeCount() - 2;
         }
     }
     
-    // Find current position in animation
-    bool keyframeUpdated = false;
-    
-    if (!isReversing) {
-        // Forward playback
-        while (nextKeyframeIndex < currentAnimation->getKeyframeCount() && 
-               effectiveTime >= (currentAnimation->getKeyFrameTime(nextKeyframeIndex) / globalSpeed)) {
-            currentKeyframeIndex = nextKeyframeIndex;
-            nextKeyframeIndex++;
-            keyframeUpdated = true;
-        }
-    } else {
-        // Reverse playback
-        unsigned long scaledAnimationDuration = animationDuration; // Already scaled above
-        while (nextKeyframeIndex >= 0 && 
-               effectiveTime >= (scaledAnimationDuration - 
-                               (currentAnimation->getKeyFrameTime(nextKeyframeIndex) / globalSpeed))) {
-            currentKeyframeIndex = nextKeyframeIndex;
-            nextKeyframeIndex--;
-            keyframeUpdated = true;
-        }
+    // Mirror the timeline when reversing
+    if (isReversing) {
+        position = animationDuration - position;
     }
     
-    // Interpolate between keyframes
+    // Evaluate, starting the segment search where the last update left off
+    int segment = isReversing ? nextKeyframeIndex : currentKeyframeIndex;
+    currentValue = currentAnimation->sampleAt(position, segment);
     if (!isReversing) {
-        if (nextKeyframeIndex < currentAnimation->getKeyframeCount()) {
-            float startVal = currentAnimation->getKeyFrameValue(currentKeyframeIndex);
-            float endVal = currentAnimation->getKeyFrameValue(nextKeyframeIndex);
-            
-            unsigned long startTimeVal = currentAnimation->getKeyFrameTime(currentKeyframeIndex) / globalSpeed;
-            unsigned long endTimeVal = currentAnimation->getKeyFrameTime(nextKeyframeIndex) / globalSpeed;
-            unsigned long segmentDuration = endTimeVal - startTimeVal;
-            
-            if (segmentDuration > 0) {
-                float t = static_cast<float>(effectiveTime - startTimeVal) / segmentDuration;
-                t = constrain(t, 0.0f, 1.0f);
-                currentValue = interpolateValue(startVal, endVal, t);
-            } else {
-                currentValue = startVal;
-            }
-        }
+        currentKeyframeIndex = segment;
+        nextKeyframeIndex = segment + 1;
     } else {
-        // Reverse playback interpolation
-        if (nextKeyframeIndex >= 0) {
-            float startVal = currentAnimation->getKeyFrameValue(currentKeyframeIndex);
-            float endVal = currentAnimation->getKeyFrameValue(nextKeyframeIndex);
-            
-            unsigned long animDuration = animationDuration; // Already scaled
-            unsigned long startTimeVal = animDuration - 
-                                      (currentAnimation->getKeyFrameTime(currentKeyframeIndex) / globalSpeed);
-            unsigned long endTimeVal = animDuration - 
-                                     (currentAnimation->getKeyFrameTime(nextKeyframeIndex) / globalSpeed);
-            unsigned long segmentDuration = endTimeVal - startTimeVal;
-            
-            if (segmentDuration > 0) {
-                float t = static_cast<float>(effectiveTime - startTimeVal) / segmentDuration;
-                t = constrain(t, 0.0f, 1.0f);
-                currentValue = interpolateValue(startVal, endVal, t);
-            } else {
-                currentValue = startVal;
-            }
-        }
+        currentKeyframeIndex = segment + 1;
+        nextKeyframeIndex = segment;
     }
     
     return currentValue;
 }
 
-void ServoNotifier::update() {
+bool NotifierBase::advance(unsigned long now) {
     if (currentState == IDLE || currentState == COMPLETED) {
-        return;
+        return false;
     }
     
     if (currentState == PAUSED) {
-        // When paused, just track time
-        totalPausedTime = millis() - pauseTime;
-        return;
+        // Paused time is added up in resume()
+        return false;
+    }
+    
+    if (startsLater) {
+        // Scheduled by playAt(): hold the first keyframe until the start
+        if (static_cast<long>(now - startTime - totalPausedTime) < 0) {
+            return true;
+        }
+        startsLater = false;
     }
     
     if (isBlending && targetAnimation != nullptr) {
         // Handle blending between animations
-        unsigned long currentTime = millis();
-        unsigned long elapsedTime = currentTime - blendStartTime;
+        unsigned long elapsedTime = now - blendStartTime;
         
         if (elapsedTime >= blendDuration) {
-            // Blend complete, switch to target animation
-            isBlending = false;
-            playAnimation(*targetAnimation, currentMode);
-            targetAnimation = nullptr;
+            // Blend complete: the target carries on alone, from where it
+            // got to during the blend. Its events start from the end of
+            // the blend
+            unsigned long blendPasses = eventCallback != nullptr ? markBlendEnd() : 0;
+            promoteTarget();
+            wrapPasses = 0;
+            calculateCurrentValue(now);
+            if (eventCallback != nullptr) {
+                wrapPasses = wrapPasses > blendPasses ? wrapPasses - blendPasses : 0;
+                eventFlags = EVENT_CROSSFADE_END;
+                queueEvents();
+            }
         } else {
-            // Calculate blend factor (0.0 to 1.0)
-            float t = static_cast<float>(elapsedTime) / blendDuration;
+            // Both animations keep playing, each from its own cursor. A
+            // finished outgoing animation holds its last value
+            if (holdOutgoing) {
+                calculateCurrentValue(now);   // Keeps the promoted animation's timing
+            } else {
+                outgoingValue = calculateCurrentValue(now);
+            }
+            currentState = PLAYING;
+            bool reversing;
+            position_t position = targetPosition(elapsedTime, reversing);
+            targetValue = targetAnimation->sampleAt(position, targetKeyframeIndex);
             
-            // Calculate blended value
-            currentValue = interpolateValue(
-                startValue, 
-                targetAnimation->getKeyFrameValue(0), 
-                t
-            );
+            // Calculate blend factor (0.0 to 1.0) and mix
+            blendWeight = ratioSample(elapsedTime, blendDuration);
+            currentValue = interpolateValue(outgoingValue, targetValue, blendWeight);
         }
-        return;
+        return true;
     }
     
     // Regular animation update
-    calculateCurrentValue();
+    if (eventCallback == nullptr) {
+        calculateCurrentValue(now);
+        return true;
+    }
+    eventFromKeyframe = currentKeyframeIndex;
+    eventFromReversing = isReversing;
+    eventFlags = 0;
+    wrapPasses = 0;
+    calculateCurrentValue(now);
+    queueEvents();
+    return true;
+}
+
+unsigned long NotifierBase::markBlendEnd() {
+    // Where the target was when the blend ended, which it reached
+    // without events. Returns the passes it wrapped by then
+    position_t duration = targetAnimation->getDuration();
+#if YBN_FIXED_POINT
+    duration <<= 8;
+#endif
+    position_t position = toPosition(blendDuration);
+    unsigned long passes = 0;
+    bool reversing = false;
+    if (position >= duration) {
+        if (targetMode == PLAY_ONCE || duration == 0) {
+            position = duration;
+        } else {
+            passes = foldPasses(position, duration);
+            reversing = targetMode == PLAY_BOOMERANG && (passes & 1);
+        }
+    }
+    int segment = targetKeyframeIndex;
+    targetAnimation->sampleAt(reversing ? duration - position : position, segment);
+    eventFromKeyframe = reversing ? segment + 1 : segment;
+    eventFromReversing = reversing;
+    if (targetAnimation->getKeyframeCount() < 2) {
+        eventFromKeyframe = 0;
+    }
+    return passes;
+}
+
+void NotifierBase::queueEvents() {
+    if (currentState == COMPLETED) {
+        eventFlags |= EVENT_COMPLETE;
+    }
+    bool moved = currentKeyframeIndex != eventFromKeyframe || isReversing != eventFromReversing;
+    eventsPending = eventFlags != 0 || wrapPasses > 0 || (moved && (eventMask & EVENT_KEYFRAME));
+}
+
+void NotifierBase::fireEvents() {
+    eventsPending = false;
+    if (currentAnimation == nullptr) {
+        return;
+    }
     
-    // Don't update hardware here - let user call servo.write with getValue()
+    // A callback that plays, seeks or stops ends the events of this update
+    uint8_t serial = eventSerial;
+    int last = currentAnimation->getKeyframeCount() - 1;
+    int from = eventFromKeyframe;
+    bool reversing = eventFromReversing;
+    if ((eventFlags & EVENT_CROSSFADE_END) && !fireEvent(EVENT_CROSSFADE_END, 0, serial)) {
+        return;
+    }
+    if (eventFlags & EVENT_COMPLETE) {
+        if (fireKeyframes(from, last, false, serial)) {
+            fireEvent(EVENT_COMPLETE, 0, serial);
+        }
+        return;
+    }
+    if (wrapPasses > 0) {
+        // The rest of this pass, then the next from its first keyframe,
+        // which the wrap stands for
+        if (!fireKeyframes(from, reversing ? 0 : last, reversing, serial) ||
+            !fireEvent(EVENT_WRAP, wrapPasses, serial)) {
+            return;
+        }
+        reversing = isReversing;
+        from = reversing ? last : 0;
+    }
+    fireKeyframes(from, currentKeyframeIndex, reversing, serial);
+}
+
+bool NotifierBase::fireKeyframes(int from, int to, bool reversing, uint8_t serial) {
+    if (!(eventMask & EVENT_KEYFRAME)) {
+        return true;
+    }
+    if (!reversing) {
+        for (int index = from + 1; index <= to; index++) {
+            if (!fireEvent(EVENT_KEYFRAME, index, serial)) {
+                return false;
+            }
+        }
+    } else {
+        for (int index = from - 1; index >= to; index--) {
+            if (!fireEvent(EVENT_KEYFRAME, index, serial)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool NotifierBase::fireEvent(NotifierEvent event, long detail, uint8_t serial) {
+    if (eventMask & event) {
+        eventCallback(*this, event, detail, eventContext);
+    }
+    return eventSerial == serial && eventCallback != nullptr;
+}
+
+void NotifierBase::setEventCallback(NotifierCallback callback, void* context, uint8_t events) {
+    eventCallback = callback;
+    eventContext = context;
+    eventMask = callback != nullptr ? events : 0;
+    eventsPending = false;
 }
 
-void ServoNotifier::setValueScale(float scale) {
-    valueScale = scale;
+void NotifierBase::setValueScale(float scale) {
+    valueScale = toSample(scale);
 }
 
-void ServoNotifier::setValueOffset(float offset) {
-    valueOffset = offset;
+void NotifierBase::setValueOffset(float offset) {
+    valueOffset = toSample(offset);
 }
 
-void ServoNotifier::setValueRange(float min, float max) {
-    minValue = min;
-    maxValue = max;
+void NotifierBase::setValueRange(float min, float max) {
+    minValue = toSample(min);
+    maxValue = toSample(max);
 }
 
-void ServoNotifier::pause() {
+void NotifierBase::pause() {
     if (currentState == PLAYING) {
         currentState = PAUSED;
-        pauseTime = millis();
+        pauseTime = clock().now();
     }
 }
 
-void ServoNotifier::resume() {
+void NotifierBase::resume() {
     if (currentState == PAUSED) {
-        totalPausedTime += (millis() - pauseTime);
+        unsigned long paused = clock().now() - pauseTime;
+        totalPausedTime += paused;
+        if (isBlending) {
+            // The blend and its target were paused too, from when the
+            // pause began or, for a crossfade started while paused, from
+            // when the blend did
+            bool blendStartedLater = static_cast<long>(blendStartTime - pauseTime) > 0;
+            blendStartTime += blendStartedLater ? clock().now() - blendStartTime : paused;
+        }
         currentState = PLAYING;
+        if (membership.group != nullptr) {
+            membership.group->activate(membership.slot);
+        }
     }
 }
 
-void ServoNotifier::stop() {
+void NotifierBase::stop() {
     currentState = IDLE;
     currentAnimation = nullptr;
     targetAnimation = nullptr;
+    wallClock = nullptr;
     isBlending = false;
+    startsLater = false;
+    eventSerial++;
+}
+
+bool NotifierBase::seek(unsigned long ms) {
+    if (currentState == IDLE || currentAnimation == nullptr) {
+        return false;
+    }
+    if (isBlending && targetAnimation != nullptr) {
+        // Seek within the animation being faded to
+        promoteTarget();
+    }
+    
+    // Fold in whole ms, which is exact for any duration
+    unsigned long duration = currentAnimation->getDuration();
+    bool reversing = false;
+    if (ms >= duration) {
+        if (currentMode == PLAY_ONCE || duration == 0) {
+            ms = duration;
+        } else {
+            unsigned long passes = ms / duration;
+            ms %= duration;
+            reversing = currentMode == PLAY_BOOMERANG && (passes & 1);
+        }
+    }
+#if YBN_FIXED_POINT
+    jumpTo(static_cast<position_t>(ms) << 8, reversing);
+#else
+    jumpTo(ms, reversing);
+#endif
+    return true;
+}
+
+bool NotifierBase::seekNormalized(float fraction) {
+    if (currentState == IDLE || currentAnimation == nullptr) {
+        return false;
+    }
+    if (isBlending && targetAnimation != nullptr) {
+        promoteTarget();
+    }
+    fraction = constrain(fraction, 0.0f, 1.0f);
+    if (fraction >= 1.0f && currentMode != PLAY_ONCE && currentAnimation->getDuration() > 0) {
+        // The end of a pass is the start of the next, as seek() has it
+        jumpTo(0, currentMode == PLAY_BOOMERANG);
+        return true;
+    }
+#if YBN_FIXED_POINT
+    jumpTo(static_cast<position_t>(fraction * (currentAnimation->getDuration() << 8)), false);
+#else
+    jumpTo(fraction * currentAnimation->getDuration(), false);
+#endif
+    return true;
+}
+
+void NotifierBase::jumpTo(position_t position, bool reversing) {
+    // Playback carries on from position in this pass, counted from now,
+    // or from the pause so that resume() picks up from here
+    unsigned long now = currentState == PAUSED ? pauseTime : clock().now();
+    startTime = now - totalPausedTime;
+    phase = position;
+    phaseFraction = 0;
+    isReversing = reversing;
+    startsLater = false;
+    eventSerial++;
+    
+    // Find the segment by binary search rather than walking to it
+    position_t duration = currentAnimation->getDuration();
+#if YBN_FIXED_POINT
+    duration <<= 8;
+#endif
+    int segment = 0;
+    currentValue = currentAnimation->sampleAt(reversing ? duration - position : position, segment);
+    if (!reversing) {
+        currentKeyframeIndex = segment;
+        nextKeyframeIndex = segment + 1;
+    } else {
+        currentKeyframeIndex = segment + 1;
+        nextKeyframeIndex = segment;
+    }
+    if (currentAnimation->getKeyframeCount() < 2) {
+        currentKeyframeIndex = 0;
+        nextKeyframeIndex = 0;
+    }
+    
+    if (currentState == COMPLETED) {
+        currentState = PLAYING;
+        if (membership.group != nullptr) {
+            membership.group->activate(membership.slot);
+        }
+    }
 }
 
-int ServoNotifier::getValue() const {
+int NotifierBase::getValue() const {
     // Apply scale and offset
-    float adjustedValue = currentValue * valueScale + valueOffset;
+    sample_t adjustedValue = mulSample(currentValue, valueScale) + valueOffset;
     
     // Constrain to range and round to nearest integer
-    return round(constrain(adjustedValue, minValue, maxValue));
+    return roundSample(constrain(adjustedValue, minValue, maxValue));
 }
 
-bool ServoNotifier::hasChanged() {
-    static int lastValue = -1;
+bool NotifierBase::hasChanged() {
     int currentIntValue = getValue();
     
-    bool changed = (currentIntValue != lastValue);
-    lastValue = currentIntValue;
+    bool changed = (currentIntValue != changeValue);
+    changeValue = currentIntValue;
     
     return changed;
 }
 
-void ServoNotifier::setGlobalSpeed(float speed) {
+unsigned long NotifierBase::getSkippedWrites() const {
+    return skippedWrites;
+}
+
+void NotifierBase::invalidateLevel() {
+    writtenLevel = LONG_MIN;
+}
+
+void NotifierBase::setGlobalSpeed(float speed) {
     // Prevent division by zero
     if (speed == 0) {
         speed = 0.001;
@@ -465,44 +2169,110 @@ void ServoNotifier::setGlobalSpeed(float speed) {
     
     // Simply update the speed factor - no timing adjustments needed
     globalSpeed = speed;
+    updateTickScale();
 }
 
-float ServoNotifier::getGlobalSpeed() const {
+float NotifierBase::getGlobalSpeed() const {
     return globalSpeed;
 }
 
-String ServoNotifier::getCurrentAnimationName() const {
+void NotifierBase::setTimeSource(const TimeSource& source) {
+    timeSource = source;
+    updateTickScale();
+}
+
+const TimeSource& NotifierBase::clock() const {
+    // Fall back to the shared default until a clock is assigned
+    return timeSource.now != nullptr ? timeSource : getDefaultTimeSource();
+}
+
+void NotifierBase::updateTickScale() {
+    // Folds globalSpeed and the clock rate into one factor so updates
+    // convert elapsed ticks to animation time with a single multiply
+#if YBN_FIXED_POINT
+    // Normalize to a full 32-bit mantissa so slow clocks keep precision
+    unsigned long ticksPerMs = clock().ticksPerMs;
+    float scale = globalSpeed * 256.0f / ticksPerMs;
+    tickShift = 0;
+    while (scale < 2147483648.0f && tickShift < 63) {
+        scale *= 2.0f;
+        tickShift++;
+    }
+    
+    // The float quotient has only 24 bits, a few ms a day, so divide
+    // globalSpeed's 24-bit mantissa by the clock rate in integers
+    int exponent;
+    uint64_t mantissa = ldexp(frexp(globalSpeed, &exponent), 24);
+    int shift = exponent - 24 + 8 + tickShift;
+    if (shift >= 0 && shift <= 39) {
+        uint64_t exact = ((mantissa << shift) + ticksPerMs / 2) / ticksPerMs;
+        tickScale = exact > UINT32_MAX ? UINT32_MAX : exact;
+    } else {
+        tickScale = scale;
+    }
+    phaseFraction = 0;   // Was in the old scale's units
+#else
+    tickScale = globalSpeed / clock().ticksPerMs;
+    // The part float rounding dropped, where double is wider (0 where it
+    // is not), so long loops keep pace with the clock
+    tickScaleLow = static_cast<double>(globalSpeed) / clock().ticksPerMs - tickScale;
+#endif
+}
+
+unsigned long NotifierBase::toTicks(unsigned long ms) const {
+    // Keyframe time (ms) to clock ticks, scaled by globalSpeed
+#if YBN_FIXED_POINT
+    // Only used by the timing queries, not by update()
+    return static_cast<float>(ms) * clock().ticksPerMs / globalSpeed + 0.5f;
+#else
+    return static_cast<float>(ms) / tickScale + 0.5f;
+#endif
+}
+
+position_t NotifierBase::toPosition(unsigned long ticks) const {
+#if YBN_FIXED_POINT
+    return (static_cast<uint64_t>(ticks) * tickScale) >> tickShift;
+#else
+    return ticks * tickScale;
+#endif
+}
+
+const String& NotifierBase::getCurrentAnimationName() const {
     if (currentAnimation != nullptr) {
         return currentAnimation->getName();
     }
-    return "";
+    return noAnimationName;
 }
 
-bool ServoNotifier::isPlaying() const {
+bool NotifierBase::isPlaying() const {
     return currentState == PLAYING;
 }
 
-bool ServoNotifier::isPaused() const {
+bool NotifierBase::isPaused() const {
     return currentState == PAUSED;
 }
 
-bool ServoNotifier::isCompleted() const {
+bool NotifierBase::isCompleted() const {
     return currentState == COMPLETED;
 }
 
-bool ServoNotifier::isBlendingAnimations() const {
+bool NotifierBase::isBlendingAnimations() const {
     return isBlending;
 }
 
-AnimationState ServoNotifier::getState() const {
+AnimationState NotifierBase::getState() const {
     return currentState;
 }
 
-bool ServoNotifier::completed() const {
+bool NotifierBase::completed() const {
     return isCompleted();
 }
 
-unsigned long ServoNotifier::timeToNextKey() const {
+unsigned long NotifierBase::timeToNextKey() const {
+    return timeToNextKey(clock().now());
+}
+
+unsigned long NotifierBase::timeToNextKey(unsigned long now) const {
     if (currentState != PLAYING || currentAnimation == nullptr) {
         return 0;
     }
@@ -513,22 +2283,21 @@ unsigned long ServoNotifier::timeToNextKey() const {
         return 0;
     }
     
-    // Get elapsed time, accounting for pauses
-    unsigned long currentTime = millis();
-    unsigned long effectiveTime = currentTime - startTime - totalPausedTime;
+    // Time into this pass, accounting for pauses
+    unsigned long effectiveTime = passTicks(now);
     
     // Get the time of the next keyframe (scaled by globalSpeed)
     unsigned long nextKeyTime;
     
     if (!isReversing) {
-        nextKeyTime = currentAnimation->getKeyFrameTime(nextKeyframeIndex) / globalSpeed;
+        nextKeyTime = toTicks(currentAnimation->getKeyFrameTime(nextKeyframeIndex));
     } else {
         // For reverse playback
-        unsigned long animationDuration = currentAnimation->getKeyFrameTime(
+        unsigned long animationDuration = toTicks(currentAnimation->getKeyFrameTime(
             currentAnimation->getKeyframeCount() - 1
-        ) / globalSpeed;
+        ));
         nextKeyTime = animationDuration - 
-                    (currentAnimation->getKeyFrameTime(nextKeyframeIndex) / globalSpeed);
+                    toTicks(currentAnimation->getKeyFrameTime(nextKeyframeIndex));
     }
     
     // If we're already past the next keyframe time, return 0
@@ -537,10 +2306,202 @@ unsigned long ServoNotifier::timeToNextKey() const {
     }
     
     // Calculate time remaining to next keyframe
-    return nextKeyTime - effectiveTime;
+    return (nextKeyTime - effectiveTime) / clock().ticksPerMs;
+}
+
+unsigned long NotifierBase::timeToNextChange() const {
+    return timeToNextChange(clock().now());
+}
+
+bool NotifierBase::getOutputBounds(float& low, float& high) const {
+    // Raw animation values that getValue() turns into its current result
+    float scale = fromSample(valueScale);
+    float offset = fromSample(valueOffset);
+    if (scale == 0.0f) {
+        return false;
+    }
+    int output = getValue();
+    low = output - 0.5f;
+    high = output + 0.5f;
+    
+    // Past the range limits the output is pinned, so it cannot change
+    if (fromSample(minValue) >= low) {
+        low = -INFINITY;
+    }
+    if (fromSample(maxValue) < high) {
+        high = INFINITY;
+    }
+    low = (low - offset) / scale;
+    high = (high - offset) / scale;
+    if (scale < 0.0f) {
+        float swap = low;
+        low = high;
+        high = swap;
+    }
+    return true;
+}
+
+float NotifierBase::timeToLeave(const KeyframeAnimation* animation, PlayMode mode, float position, bool reversing,
+                                float low, float high) const {
+    // Animation ms until the value leaves low..high, following the
+    // playback mode from position on the animation's timeline
+    float duration = animation->getDuration();
+    float time;
+    if (mode == PLAY_ONCE) {
+        return animation->timeUntilOutside(position, duration, low, high);
+    }
+    if (mode == PLAY_LOOP) {
+        time = animation->timeUntilOutside(position, duration, low, high);
+        if (time >= 0) {
+            return time;
+        }
+        time = animation->timeUntilOutside(0, position, low, high);
+        return time >= 0 ? duration - position + time : -1.0f;
+    }
+    
+    // Boomerang: to the end this pass is heading for, then all the way back
+    float turn = reversing ? 0 : duration;
+    time = animation->timeUntilOutside(position, turn, low, high);
+    if (time >= 0) {
+        return time;
+    }
+    time = animation->timeUntilOutside(turn, duration - turn, low, high);
+    return time >= 0 ? fabsf(turn - position) + time : -1.0f;
+}
+
+unsigned long NotifierBase::timeToNextChange(unsigned long now) const {
+    if (currentState != PLAYING || currentAnimation == nullptr) {
+        return NO_CHANGE;
+    }
+    float low;
+    float high;
+    if (!getOutputBounds(low, high)) {
+        return NO_CHANGE;
+    }
+    
+    // Clock ticks per animation ms
+    float tickRate = clock().ticksPerMs / globalSpeed;
+    if (tickRate <= 0) {
+        return 0;
+    }
+    
+    const KeyframeAnimation* animation = currentAnimation;
+    PlayMode mode = currentMode;
+    bool reversing = false;
+    float position = 0;
+    float wait = 0;
+    if (startsLater && static_cast<long>(now - startTime - totalPausedTime) < 0) {
+        // Nothing moves before a playAt() start
+        wait = startTime + totalPausedTime - now;
+    } else if (isBlending && targetAnimation != nullptr) {
+        unsigned long elapsed = now - blendStartTime;
+        if (elapsed < blendDuration) {
+            return timeToLeaveBlend(now, low, high, tickRate);
+        }
+        
+        // Blend over but not yet handed over: the target alone
+        animation = targetAnimation;
+        mode = targetMode;
+        position = targetPosition(elapsed, reversing);
+#if YBN_FIXED_POINT
+        position /= 256.0f;   // Q24.8
+#endif
+    } else {
+        position = playbackPosition(now, reversing);
+    }
+    
+    float time = timeToLeave(animation, mode, position, reversing, low, high);
+    if (time < 0) {
+        return NO_CHANGE;
+    }
+    float ticks = wait + time * tickRate;
+    return ticks < NO_CHANGE - 1.0f ? static_cast<unsigned long>(ticks) : NO_CHANGE - 1;
+}
+
+float NotifierBase::playbackPosition(unsigned long now, bool& reversing) const {
+    // Position on the current animation's timeline, in animation ms,
+    // folded the way the next update() will
+    float position = phase + toPosition(now - startTime - totalPausedTime);
+#if YBN_FIXED_POINT
+    position /= 256.0f;   // Q24.8
+#endif
+    float duration = currentAnimation->getDuration();
+    reversing = isReversing;
+    if (position >= duration) {
+        if (currentMode == PLAY_ONCE || duration <= 0) {
+            position = duration;
+        } else {
+            float passes = floorf(position / duration);
+            position = fmodf(position, duration);
+            if (currentMode == PLAY_BOOMERANG && fmodf(passes, 2.0f) >= 1.0f) {
+                reversing = !reversing;
+            }
+        }
+    }
+    if (reversing) {
+        position = duration - position;
+    }
+    return position;
+}
+
+unsigned long NotifierBase::passTicks(unsigned long now) const {
+    // Clock ticks into the current pass, including the phase carried
+    // over from the last wrap
+#if YBN_FIXED_POINT
+    float phaseMs = phase / 256.0f;
+#else
+    float phaseMs = phase;
+#endif
+    unsigned long phaseTicks = phaseMs * clock().ticksPerMs / globalSpeed + 0.5f;
+    return now - startTime - totalPausedTime + phaseTicks;
+}
+
+unsigned long NotifierBase::timeToLeaveBlend(unsigned long now, float low, float high, float tickRate) const {
+    // The mix cannot leave low..high before one of the animations moves
+    // by half the margin, or the changing weight moves it by the other half
+    float value = fromSample(currentValue);
+    float margin = value - low < high - value ? value - low : high - value;
+    if (!(margin > 0)) {
+        return 0;
+    }
+    float band = margin * 0.5f;
+    unsigned long elapsed = now - blendStartTime;
+    float ticks = blendDuration - elapsed;   // Then the target plays alone
+    
+    float gap = fabsf(fromSample(targetValue) - fromSample(outgoingValue));
+    if (gap * ticks > band * blendDuration) {
+        ticks = band / gap * blendDuration;
+    }
+    
+    bool reversing;
+    float position;
+    float time;
+    if (!holdOutgoing) {
+        position = playbackPosition(now, reversing);
+        float from = fromSample(outgoingValue);
+        time = timeToLeave(currentAnimation, currentMode, position, reversing, from - band, from + band);
+        if (time >= 0 && time * tickRate < ticks) {
+            ticks = time * tickRate;
+        }
+    }
+    
+    position = targetPosition(elapsed, reversing);
+#if YBN_FIXED_POINT
+    position /= 256.0f;   // Q24.8
+#endif
+    float to = fromSample(targetValue);
+    time = timeToLeave(targetAnimation, targetMode, position, reversing, to - band, to + band);
+    if (time >= 0 && time * tickRate < ticks) {
+        ticks = time * tickRate;
+    }
+    return static_cast<unsigned long>(ticks);
+}
+
+unsigned long NotifierBase::timeRemaining() const {
+    return timeRemaining(clock().now());
 }
 
-unsigned long ServoNotifier::timeRemaining() const {
+unsigned long NotifierBase::timeRemaining(unsigned long now) const {
     if (currentState != PLAYING || currentAnimation == nullptr) {
         return 0;
     }
@@ -552,29 +2513,27 @@ unsigned long ServoNotifier::timeRemaining() const {
     // For looping animations, there's no true "end"
     if (currentMode == PLAY_LOOP || currentMode == PLAY_BOOMERANG) {
         // Return time to complete current cycle
-        unsigned long currentTime = millis();
-        unsigned long effectiveTime = currentTime - startTime - totalPausedTime;
+        unsigned long effectiveTime = passTicks(now);
         
-        unsigned long animationDuration = currentAnimation->getKeyFrameTime(
+        unsigned long animationDuration = toTicks(currentAnimation->getKeyFrameTime(
             currentAnimation->getKeyframeCount() - 1
-        ) / globalSpeed;
+        ));
         
         if (isReversing && currentMode == PLAY_BOOMERANG) {
             // For boomerang in reverse direction, calculate time to get back to the start
-            return animationDuration - (effectiveTime % animationDuration);
+            return (animationDuration - (effectiveTime % animationDuration)) / clock().ticksPerMs;
         } else {
             // For regular loop or boomerang in forward direction
-            return animationDuration - (effectiveTime % animationDuration);
+            return (animationDuration - (effectiveTime % animationDuration)) / clock().ticksPerMs;
         }
     }
     
     // For PLAY_ONCE mode
-    unsigned long currentTime = millis();
-    unsigned long effectiveTime = currentTime - startTime - totalPausedTime;
+    unsigned long effectiveTime = passTicks(now);
     
-    unsigned long animationDuration = currentAnimation->getKeyFrameTime(
+    unsigned long animationDuration = toTicks(currentAnimation->getKeyFrameTime(
         currentAnimation->getKeyframeCount() - 1
-    ) * globalSpeed;
+    ));
     
     // If we're already past the end, return 0
     if (effectiveTime >= animationDuration) {
@@ -582,25 +2541,29 @@ unsigned long ServoNotifier::timeRemaining() const {
     }
     
     // Calculate time remaining to the end
-    return animationDuration - effectiveTime;
+    return (animationDuration - effectiveTime) / clock().ticksPerMs;
 }
 
 // Implementation of missing functions
 
-PlayMode ServoNotifier::getPlaybackMode() const {
+PlayMode NotifierBase::getPlaybackMode() const {
     return currentMode;
 }
 
-unsigned long ServoNotifier::getElapsedTime() const {
+unsigned long NotifierBase::getElapsedTime() const {
+    return getElapsedTime(clock().now());
+}
+
+unsigned long NotifierBase::getElapsedTime(unsigned long now) const {
     if (currentState != PLAYING) {
         return 0;
     }
     
-    // Calculate elapsed time accounting for pauses
-    return millis() - startTime - totalPausedTime;
+    // Calculate elapsed time in this pass, accounting for pauses
+    return passTicks(now) / clock().ticksPerMs;
 }
 
-unsigned long ServoNotifier::getTotalDuration() const {
+unsigned long NotifierBase::getTotalDuration() const {
     if (currentAnimation == nullptr || currentAnimation->getKeyframeCount() < 1) {
         return 0;
     }
@@ -609,7 +2572,7 @@ unsigned long ServoNotifier::getTotalDuration() const {
     return currentAnimation->getKeyFrameTime(currentAnimation->getKeyframeCount() - 1);
 }
 
-float ServoNotifier::getStartValue() const {
+float NotifierBase::getStartValue() const {
     if (currentAnimation == nullptr || currentAnimation->getKeyframeCount() < 1) {
         return 0.0f;
     }
@@ -618,7 +2581,7 @@ float ServoNotifier::getStartValue() const {
     return currentAnimation->getKeyFrameValue(0);
 }
 
-float ServoNotifier::getEndValue() const {
+float NotifierBase::getEndValue() const {
     if (currentAnimation == nullptr || currentAnimation->getKeyframeCount() < 1) {
         return 0.0f;
     }
@@ -627,601 +2590,567 @@ float ServoNotifier::getEndValue() const {
     return currentAnimation->getKeyFrameValue(currentAnimation->getKeyframeCount() - 1);
 }
 
-bool ServoNotifier::hasAnimation(const String& name) const {
+bool NotifierBase::hasAnimation(const String& name) const {
     // Check if animation with given name exists in the collection
-    for (const auto& anim : animations) {
-        if (anim.getName() == name) {
-            return true;
-        }
-    }
-    return false;
+    return getAnimationId(name) != NO_ANIMATION;
 }
 
-int ServoNotifier::getAnimationCount() const {
+int NotifierBase::getAnimationCount() const {
     return animations.size();
 }
 
-std::vector<String> ServoNotifier::getAnimationNames() const {
+const String& NotifierBase::getAnimationName(int index) const {
+    if (index < 0 || index >= static_cast<int>(animations.size())) {
+        return noAnimationName;
+    }
+    return getAnimationLibrary().get(animations[index])->getName();
+}
+
+std::vector<String> NotifierBase::getAnimationNames() const {
     std::vector<String> names;
-    for (const auto& anim : animations) {
-        names.push_back(anim.getName());
+    for (AnimationId id : animations) {
+        names.push_back(getAnimationLibrary().get(id)->getName());
     }
     return names;
 }
 
 //======================================================================
-// LEDNotifier Implementation
+// ServoNotifier and LEDNotifier Implementation
 //======================================================================
 
-LEDNotifier::LEDNotifier(int pin, LEDMode mode) 
-    : pin(pin), 
-      mode(mode), 
-      threshold(0.5f),
-      currentAnimation(nullptr),
-      targetAnimation(nullptr),
-      currentMode(PLAY_ONCE),
-      currentState(IDLE),
-      globalSpeed(1.0),
-      startTime(0),
-      pauseTime(0),
-      totalPausedTime(0),
-      currentKeyframeIndex(0),
-      nextKeyframeIndex(0),
-      currentValue(0.0),
-      isReversing(false),
-      isPlayingBackward(false),
-      valueScale(1.0),
-      valueOffset(0.0),
-      minValue(-INFINITY),
-      maxValue(INFINITY),
-      isBlending(false),
-      blendStartTime(0),
-      blendDuration(0),
-      startValue(0.0) {
-}
-
-void LEDNotifier::begin() {
-    pinMode(pin, OUTPUT);
-    digitalWrite(pin, LOW);
+// New constructor that doesn't require a Servo object
+ServoNotifier::ServoNotifier(int minAngle, int maxAngle)
+    : Notifier<ServoOutput>(ServoOutput(nullptr, minAngle, maxAngle)) {
 }
 
-void LEDNotifier::setMode(LEDMode newMode) {
-    mode = newMode;
+ServoNotifier::ServoNotifier(Servo& servo, int minAngle, int maxAngle)
+    : Notifier<ServoOutput>(ServoOutput(&servo, minAngle, maxAngle)) {
 }
 
-void LEDNotifier::setThreshold(float newThreshold) {
-    threshold = constrain(newThreshold, 0.0f, 1.0f);
+LEDNotifier::LEDNotifier(int pin, LEDMode mode)
+    : Notifier<LEDOutput>(LEDOutput(pin, mode)) {
 }
 
-void LEDNotifier::addAnimation(const KeyframeAnimation& animation) {
-    // Only add if it has keyframes and isn't already in our list
-    if (animation.getKeyframeCount() == 0) {
-        return;
-    }
-    
-    // Check for duplicate name
-    for (const auto& anim : animations) {
-        if (anim.getName() == animation.getName()) {
-            return; // Skip duplicates
-        }
-    }
-    
-    animations.push_back(animation);
+void LEDNotifier::begin() {
+    LEDOutput::begin();
+    invalidateLevel();
 }
 
-void LEDNotifier::playAnimation(const KeyframeAnimation& animation, PlayMode mode) {
-    if (animation.getKeyframeCount() < 1) {
-        return;
-    }
-    
-    // Stop any current animation
-    stop();
-    
-    // Set up new animation
-    for (const auto& anim : animations) {
-        if (anim.getName() == animation.getName()) {
-            currentAnimation = const_cast<KeyframeAnimation*>(&anim);
-            break;
-        }
-    }
-    
-    // If not in our collection, use the provided one directly
-    if (currentAnimation == nullptr) {
-        addAnimation(animation);
-        for (auto& anim : animations) {
-            if (anim.getName() == animation.getName()) {
-                currentAnimation = &anim;
-                break;
-            }
-        }
-    }
-    
-    // Initialize playback state
-    currentMode = mode;
-    isReversing = false;
-    isPlayingBackward = false;
-    currentKeyframeIndex = 0;
-    nextKeyframeIndex = 1;
-    
-    if (currentAnimation->getKeyframeCount() > 1) {
-        nextKeyframeIndex = 1;
-    } else {
-        nextKeyframeIndex = 0;
-    }
-    
-    // Start timing
-    startTime = millis();
-    totalPausedTime = 0;
-    
-    // Initial value
-    currentValue = currentAnimation->getKeyFrameValue(0);
-    
-    // Set state
-    currentState = PLAYING;
+void LEDNotifier::setMode(LEDMode newMode) {
+    LEDOutput::setMode(newMode);
+    invalidateLevel();
 }
 
-bool LEDNotifier::playAnimation(const String& name, PlayMode mode) {
-    // Find animation by name
-    for (auto& anim : animations) {
-        if (anim.getName() == name) {
-            playAnimation(anim, mode);
-            return true;
-        }
-    }
-    return false;
+SinkNotifier::SinkNotifier(OutputSink& sink, int channel)
+    : Notifier<SinkOutput>(SinkOutput(&sink, channel)) {
 }
-
-void LEDNotifier::crossfadeTo(const KeyframeAnimation& animation, unsigned long blendTime, PlayMode mode) {
-    if (animation.getKeyframeCount() < 1 || currentState == IDLE) {
-        // If no animation is playing, just start the new one
-        playAnimation(animation, mode);
-        return;
-    }
-    
-    // Save current value for blending
-    startValue = currentValue;
-    
-    // Find the target animation in our collection
-    targetAnimation = nullptr;
-    for (auto& anim : animations) {
-        if (anim.getName() == animation.getName()) {
-            targetAnimation = &anim;
-            break;
-        }
-    }
-    
-    // If not in our collection, add it
-    if (targetAnimation == nullptr) {
-        addAnimation(animation);
-        for (auto& anim : animations) {
-            if (anim.getName() == animation.getName()) {
-                targetAnimation = &anim;
-                break;
-            }
-        }
+
+//======================================================================
+// NotifierGroup Implementation
+//======================================================================
+
+NotifierGroup::NotifierGroup() : timeline(nullptr), timeSource() {
+}
+
+NotifierGroup::~NotifierGroup() {
+    // Detach members so they don't report to a destroyed group
+    for (auto& channel : channels) {
+        channel.notifier->membership.group = nullptr;
     }
-    
-    // Set up blending
-    isBlending = true;
-    blendStartTime = millis();
-    blendDuration = blendTime;
 }
 
-bool LEDNotifier::crossfadeTo(const String& name, unsigned long blendTime, PlayMode mode) {
-    // Find animation by name
-    for (auto& anim : animations) {
-        if (anim.getName() == name) {
-            crossfadeTo(anim, blendTime, mode);
+bool NotifierGroup::add(ServoNotifier& notifier) {
+    return join(notifier, SERVO_CHANNEL);
+}
+
+bool NotifierGroup::add(LEDNotifier& notifier) {
+    return join(notifier, LED_CHANNEL);
+}
+
+bool NotifierGroup::add(SinkNotifier& notifier) {
+    if (!join(notifier, SINK_CHANNEL)) {
+        return false;
+    }
+    OutputSink* sink = &notifier.getSink();
+    for (OutputSink* known : sinks) {
+        if (known == sink) {
             return true;
         }
     }
-    return false;
+    sinks.push_back(sink);
+    return true;
 }
 
-float LEDNotifier::interpolateValue(float startVal, float endVal, float t) {
-    // Linear interpolation
-    return startVal + (endVal - startVal) * t;
+bool NotifierGroup::add(RGBNotifier& notifier) {
+    return join(notifier, RGB_CHANNEL);
 }
 
-float LEDNotifier::calculateCurrentValue() {
-    if (currentAnimation == nullptr || currentAnimation->getKeyframeCount() < 1) {
-        return currentValue;
-    }
-    
-    // Get elapsed time, accounting for pauses
-    unsigned long currentTime = millis();
-    unsigned long effectiveTime = currentTime - startTime - totalPausedTime;
-    
-    // Handle single keyframe case
-    if (currentAnimation->getKeyframeCount() == 1) {
-        currentValue = currentAnimation->getKeyFrameValue(0);
-        return currentValue;
+bool NotifierGroup::join(NotifierBase& notifier, ChannelKind kind) {
+    if (notifier.membership.group != nullptr) {
+        return false;
     }
-    
-    // Get animation duration (scaled by globalSpeed)
-    unsigned long animationDuration = currentAnimation->getKeyFrameTime(
-        currentAnimation->getKeyframeCount() - 1
-    ) / globalSpeed;
-    
-    // Handle animation completion
-    if (effectiveTime >= animationDuration) {
-        if (currentMode == PLAY_ONCE) {
-            // Animation complete
-            currentValue = currentAnimation->getKeyFrameValue(
-                currentAnimation->getKeyframeCount() - 1
-            );
-            currentState = COMPLETED;
-            return currentValue;
-        } else if (currentMode == PLAY_LOOP) {
-            // Loop back to start
-            startTime = currentTime - totalPausedTime;
-            effectiveTime = 0;
-            currentKeyframeIndex = 0;
-            nextKeyframeIndex = 1;
-        } else if (currentMode == PLAY_BOOMERANG) {
-            if (!isReversing) {
-                // Switch to reverse playback
-                isReversing = true;
-                startTime = currentTime - totalPausedTime;
-                effectiveTime = 0;
-                currentKeyframeIndex = currentAnimation->getKeyframeCount() - 1;
-                nextKeyframeIndex = currentAnimation->getKeyframeCount() - 2;
-            } else {
-                // Switch to forward playback
-                isReversing = false;
-                startTime = currentTime - totalPausedTime;
-                effectiveTime = 0;
-                currentKeyframeIndex = 0;
-                nextKeyframeIndex = 1;
-            }
-        }
+    notifier.membership.group = this;
+    notifier.membership.slot = channels.size();
+    if (timeSource.now != nullptr) {
+        notifier.setTimeSource(timeSource);
     }
+    Channel channel = {&notifier, kind, -1};
+    channels.push_back(channel);
     
-    // Find current position in animation
-    bool keyframeUpdated = false;
-    
-    if (!isReversing) {
-        // Forward playback
-        while (nextKeyframeIndex < currentAnimation->getKeyframeCount() && 
-               effectiveTime >= (currentAnimation->getKeyFrameTime(nextKeyframeIndex) / globalSpeed)) {
-            currentKeyframeIndex = nextKeyframeIndex;
-            nextKeyframeIndex++;
-            keyframeUpdated = true;
-        }
-    } else {
-        // Reverse playback
-        unsigned long scaledAnimationDuration = animationDuration; // Already scaled above
-        while (nextKeyframeIndex >= 0 && 
-               effectiveTime >= (scaledAnimationDuration - 
-                               (currentAnimation->getKeyFrameTime(nextKeyframeIndex) / globalSpeed))) {
-            currentKeyframeIndex = nextKeyframeIndex;
-            nextKeyframeIndex--;
-            keyframeUpdated = true;
-        }
+    // Reserve now so activating a channel never allocates
+    switch (kind) {
+        case SERVO_CHANNEL: activeServos.reserve(channels.size()); break;
+        case LED_CHANNEL:   activeLEDs.reserve(channels.size()); break;
+        case SINK_CHANNEL:  activeSinkChannels.reserve(channels.size()); break;
+        case RGB_CHANNEL:   activeRGBs.reserve(channels.size()); break;
     }
     
-    // Interpolate between keyframes
-    if (!isReversing) {
-        if (nextKeyframeIndex < currentAnimation->getKeyframeCount()) {
-            float startVal = currentAnimation->getKeyFrameValue(currentKeyframeIndex);
-            float endVal = currentAnimation->getKeyFrameValue(nextKeyframeIndex);
-            
-            unsigned long startTimeVal = currentAnimation->getKeyFrameTime(currentKeyframeIndex) / globalSpeed;
-            unsigned long endTimeVal = currentAnimation->getKeyFrameTime(nextKeyframeIndex) / globalSpeed;
-            unsigned long segmentDuration = endTimeVal - startTimeVal;
-            
-            if (segmentDuration > 0) {
-                float t = static_cast<float>(effectiveTime - startTimeVal) / segmentDuration;
-                t = constrain(t, 0.0f, 1.0f);
-                currentValue = interpolateValue(startVal, endVal, t);
-            } else {
-                currentValue = startVal;
-            }
-        }
-    } else {
-        // Reverse playback interpolation
-        if (nextKeyframeIndex >= 0) {
-            float startVal = currentAnimation->getKeyFrameValue(currentKeyframeIndex);
-            float endVal = currentAnimation->getKeyFrameValue(nextKeyframeIndex);
-            
-            unsigned long animDuration = animationDuration; // Already scaled
-            unsigned long startTimeVal = animDuration - 
-                                       (currentAnimation->getKeyFrameTime(currentKeyframeIndex) / globalSpeed);
-            unsigned long endTimeVal = animDuration - 
-                                     (currentAnimation->getKeyFrameTime(nextKeyframeIndex) / globalSpeed);
-            unsigned long segmentDuration = endTimeVal - startTimeVal;
-            
-            if (segmentDuration > 0) {
-                float t = static_cast<float>(effectiveTime - startTimeVal) / segmentDuration;
-                t = constrain(t, 0.0f, 1.0f);
-                currentValue = interpolateValue(startVal, endVal, t);
-            } else {
-                currentValue = startVal;
-            }
-        }
+    if (notifier.isPlaying()) {
+        activate(channels.size() - 1);
     }
-    
-    return currentValue;
+    return true;
 }
 
-void LEDNotifier::update() {
-    if (currentState == IDLE || currentState == COMPLETED) {
+void NotifierGroup::activate(int slot) {
+    Channel& channel = channels[slot];
+    if (channel.activeIndex >= 0) {
         return;
     }
-    
-    if (currentState == PAUSED) {
-        // When paused, just track time
-        totalPausedTime = millis() - pauseTime;
-        return;
+    switch (channel.kind) {
+        case SERVO_CHANNEL:
+            channel.activeIndex = activeServos.size();
+            activeServos.push_back(static_cast<ServoNotifier*>(channel.notifier));
+            break;
+        case LED_CHANNEL:
+            channel.activeIndex = activeLEDs.size();
+            activeLEDs.push_back(static_cast<LEDNotifier*>(channel.notifier));
+            break;
+        case SINK_CHANNEL:
+            channel.activeIndex = activeSinkChannels.size();
+            activeSinkChannels.push_back(static_cast<SinkNotifier*>(channel.notifier));
+            break;
+        case RGB_CHANNEL:
+            channel.activeIndex = activeRGBs.size();
+            activeRGBs.push_back(static_cast<RGBNotifier*>(channel.notifier));
+            break;
     }
-    
-    if (isBlending && targetAnimation != nullptr) {
-        // Handle blending between animations
-        unsigned long currentTime = millis();
-        unsigned long elapsedTime = currentTime - blendStartTime;
+}
+
+template <typename Notifier>
+void NotifierGroup::updateActive(std::vector<Notifier*>& list, unsigned long now) {
+    size_t i = 0;
+    while (i < list.size()) {
+        Notifier* notifier = list[i];
+        notifier->update(now);
+        if (notifier->isPlaying()) {
+            i++;
+            continue;
+        }
         
-        if (elapsedTime >= blendDuration) {
-            // Blend complete, switch to target animation
-            isBlending = false;
-            playAnimation(*targetAnimation, currentMode);
-            targetAnimation = nullptr;
-        } else {
-            // Calculate blend factor (0.0 to 1.0)
-            float t = static_cast<float>(elapsedTime) / blendDuration;
-            
-            // Calculate blended value
-            currentValue = interpolateValue(
-                startValue, 
-                targetAnimation->getKeyFrameValue(0), 
-                t
-            );
+        // Finished or paused: drop out until played or resumed again
+        channels[notifier->membership.slot].activeIndex = -1;
+        dropActive(list, i);
+    }
+}
+
+template <typename Notifier>
+void NotifierGroup::dropActive(std::vector<Notifier*>& list, int index) {
+    // Move the last active channel into the freed position
+    Notifier* last = list.back();
+    list.pop_back();
+    if (index < static_cast<int>(list.size())) {
+        list[index] = last;
+        channels[last->membership.slot].activeIndex = index;
+    }
+}
+
+void NotifierGroup::leave(int slot) {
+    Channel& channel = channels[slot];
+    if (channel.activeIndex >= 0) {
+        switch (channel.kind) {
+            case SERVO_CHANNEL: dropActive(activeServos, channel.activeIndex); break;
+            case LED_CHANNEL:   dropActive(activeLEDs, channel.activeIndex); break;
+            case SINK_CHANNEL:  dropActive(activeSinkChannels, channel.activeIndex); break;
+            case RGB_CHANNEL:   dropActive(activeRGBs, channel.activeIndex); break;
         }
-        return;
     }
     
-    // First update animation values
-    calculateCurrentValue();
-    
-    // Apply value to the LED
-    if (mode == ANALOG) {
-        // For analog (PWM) mode
-        int pwmValue = constrain(round(getValue()), 0, 255);
-        analogWrite(pin, pwmValue);
-    } else {
-        // For digital (ON/OFF) mode - use threshold
-        if (getValue() >= threshold) {
-            digitalWrite(pin, HIGH);
-        } else {
-            digitalWrite(pin, LOW);
-        }
+    // Move the last channel into the freed slot
+    Channel last = channels.back();
+    channels.pop_back();
+    if (slot < static_cast<int>(channels.size())) {
+        channels[slot] = last;
+        last.notifier->membership.slot = slot;
     }
 }
 
-void LEDNotifier::setValueScale(float scale) {
-    valueScale = scale;
+void NotifierGroup::setTimeSource(const TimeSource& source) {
+    timeSource = source;
+    for (auto& channel : channels) {
+        channel.notifier->setTimeSource(source);
+    }
+    if (timeline != nullptr) {
+        timeline->setTimeSource(source);
+    }
 }
 
-void LEDNotifier::setValueOffset(float offset) {
-    valueOffset = offset;
+void NotifierGroup::setTimeline(Timeline* cues) {
+    timeline = cues;
+    if (timeline != nullptr && timeSource.now != nullptr) {
+        timeline->setTimeSource(timeSource);
+    }
 }
 
-void LEDNotifier::setValueRange(float min, float max) {
-    minValue = min;
-    maxValue = max;
+unsigned long NotifierGroup::timeToNextChange() const {
+    const TimeSource& clock = timeSource.now != nullptr ? timeSource : getDefaultTimeSource();
+    return timeToNextChange(clock.now());
 }
 
-void LEDNotifier::pause() {
-    if (currentState == PLAYING) {
-        currentState = PAUSED;
-        pauseTime = millis();
+unsigned long NotifierGroup::timeToNextChange(unsigned long now) const {
+    // Only playing notifiers can change, and they are all in the active
+    // lists. A cue can start one changing
+    unsigned long earliest = timeline != nullptr ? timeline->timeToNextCue(now) : NO_CHANGE;
+    for (const ServoNotifier* notifier : activeServos) {
+        unsigned long ticks = notifier->timeToNextChange(now);
+        earliest = ticks < earliest ? ticks : earliest;
+    }
+    for (const LEDNotifier* notifier : activeLEDs) {
+        unsigned long ticks = notifier->timeToNextChange(now);
+        earliest = ticks < earliest ? ticks : earliest;
     }
+    for (const SinkNotifier* notifier : activeSinkChannels) {
+        unsigned long ticks = notifier->timeToNextChange(now);
+        earliest = ticks < earliest ? ticks : earliest;
+    }
+    for (const RGBNotifier* notifier : activeRGBs) {
+        unsigned long ticks = notifier->timeToNextChange(now);
+        earliest = ticks < earliest ? ticks : earliest;
+    }
+    return earliest;
 }
 
-void LEDNotifier::resume() {
-    if (currentState == PAUSED) {
-        totalPausedTime += (millis() - pauseTime);
-        currentState = PLAYING;
+void NotifierGroup::update() {
+    const TimeSource& clock = timeSource.now != nullptr ? timeSource : getDefaultTimeSource();
+    update(clock.now());
+}
+
+void NotifierGroup::update(unsigned long now) {
+    // Cues first, so the animations they start are updated this frame
+    if (timeline != nullptr) {
+        timeline->update(now);
+    }
+    updateActive(activeServos, now);
+    updateActive(activeLEDs, now);
+    updateActive(activeSinkChannels, now);
+    updateActive(activeRGBs, now);
+    
+    // One transaction per sink for everything that changed this frame
+    for (OutputSink* sink : sinks) {
+        sink->flush();
     }
 }
 
-void LEDNotifier::stop() {
-    currentState = IDLE;
-    currentAnimation = nullptr;
-    targetAnimation = nullptr;
-    isBlending = false;
+int NotifierGroup::getCount() const {
+    return channels.size();
 }
 
-int LEDNotifier::getValue() const {
-    // Apply scale and offset
-    float adjustedValue = currentValue * valueScale + valueOffset;
-    
-    // Constrain to range and round to nearest integer
-    return round(constrain(adjustedValue, minValue, maxValue));
+int NotifierGroup::getActiveCount() const {
+    return activeServos.size() + activeLEDs.size() + activeSinkChannels.size() + activeRGBs.size();
 }
 
-bool LEDNotifier::hasChanged() {
-    static int lastValue = -1;
-    int currentIntValue = getValue();
-    
-    bool changed = (currentIntValue != lastValue);
-    lastValue = currentIntValue;
-    
-    return changed;
+//======================================================================
+// Timeline Implementation
+//======================================================================
+
+Timeline::Timeline()
+    : nextCue(0),
+      baseMs(0),
+      baseTick(0),
+      running(false),
+      timeSource() {
 }
 
-void LEDNotifier::setGlobalSpeed(float speed) {
-    // Prevent division by zero
-    if (speed == 0) {
-        speed = 0.001;
+void Timeline::reserve(int cueCount) {
+    if (cueCount > 0) {
+        cues.reserve(cueCount);
+    }
+}
+
+bool Timeline::addCue(unsigned long time, NotifierBase& notifier, AnimationId animation,
+                      PlayMode mode, unsigned long blendTime) {
+    if (!notifier.canPlay(getAnimationLibrary().get(animation))) {
+        return false;
     }
     
-    // Simply update the speed factor - no timing adjustments needed
-    globalSpeed = speed;
+    // After every cue at or before this time: O(1) when added in order
+    int index = cues.size();
+    if (index > 0 && cues[index - 1].time > time) {
+        int low = 0;
+        int high = index - 1;
+        while (low < high) {
+            int mid = (low + high) / 2;
+            if (cues[mid].time > time) {
+                high = mid;
+            } else {
+                low = mid + 1;
+            }
+        }
+        index = low;
+    }
+    Cue cue = {time, &notifier, animation, mode, blendTime};
+    cues.insert(cues.begin() + index, cue);
+    if (index < nextCue) {
+        nextCue++;   // Behind the cursor: already passed
+    }
+    return true;
 }
 
-float LEDNotifier::getGlobalSpeed() const {
-    return globalSpeed;
+bool Timeline::addCue(unsigned long time, NotifierBase& notifier, const String& name,
+                      PlayMode mode, unsigned long blendTime) {
+    return addCue(time, notifier, notifier.getAnimationId(name), mode, blendTime);
 }
 
-String LEDNotifier::getCurrentAnimationName() const {
-    if (currentAnimation != nullptr) {
-        return currentAnimation->getName();
-    }
-    return "";
+void Timeline::clear() {
+    cues.clear();
+    nextCue = 0;
 }
 
-bool LEDNotifier::isPlaying() const {
-    return currentState == PLAYING;
+void Timeline::setTimeSource(const TimeSource& source) {
+    timeSource = source;
 }
 
-bool LEDNotifier::isPaused() const {
-    return currentState == PAUSED;
+const TimeSource& Timeline::clock() const {
+    return timeSource.now != nullptr ? timeSource : getDefaultTimeSource();
 }
 
-bool LEDNotifier::isCompleted() const {
-    return currentState == COMPLETED;
+void Timeline::start() {
+    start(clock().now());
 }
 
-bool LEDNotifier::isBlendingAnimations() const {
-    return isBlending;
+void Timeline::start(unsigned long now) {
+    baseMs = 0;
+    baseTick = now;
+    nextCue = 0;
+    running = true;
 }
 
-AnimationState LEDNotifier::getState() const {
-    return currentState;
+void Timeline::stop() {
+    running = false;
 }
 
-bool LEDNotifier::completed() const {
-    return isCompleted();
+int Timeline::update() {
+    return update(clock().now());
 }
 
-unsigned long LEDNotifier::timeToNextKey() const {
-    if (currentState != PLAYING || currentAnimation == nullptr) {
+int Timeline::update(unsigned long now) {
+    if (!running) {
         return 0;
     }
-    
-    if (currentAnimation->getKeyframeCount() <= 1 || 
-        nextKeyframeIndex >= currentAnimation->getKeyframeCount() ||
-        nextKeyframeIndex < 0) {
-        return 0;
+    if (static_cast<long>(now - baseTick) < 0) {
+        return 0;   // Before the last update
     }
     
-    // Get elapsed time, accounting for pauses
-    unsigned long currentTime = millis();
-    unsigned long effectiveTime = currentTime - startTime - totalPausedTime;
-    
-    // Get the time of the next keyframe (scaled by globalSpeed)
-    unsigned long nextKeyTime;
-    
-    if (!isReversing) {
-        nextKeyTime = currentAnimation->getKeyFrameTime(nextKeyframeIndex) / globalSpeed;
-    } else {
-        // For reverse playback
-        unsigned long animationDuration = currentAnimation->getKeyFrameTime(
-            currentAnimation->getKeyframeCount() - 1
-        ) * globalSpeed;
-        nextKeyTime = animationDuration - 
-                     (currentAnimation->getKeyFrameTime(nextKeyframeIndex) / globalSpeed);
+    // Count in whole ms rather than ticks since start(), which micros()
+    // wraps after 71 minutes on 32-bit boards
+    unsigned long ticksPerMs = clock().ticksPerMs;
+    unsigned long wholeMs = (now - baseTick) / ticksPerMs;
+    baseMs += wholeMs;
+    baseTick += wholeMs * ticksPerMs;
+    int fired = 0;
+    while (nextCue < static_cast<int>(cues.size()) && cues[nextCue].time <= baseMs) {
+        // Advance first: a cue may add cues or restart the timeline
+        const Cue cue = cues[nextCue++];
+        fire(cue, (baseMs - cue.time) * ticksPerMs + (now - baseTick));
+        fired++;
     }
+    return fired;
+}
+
+void Timeline::fire(const Cue& cue, unsigned long late) {
+    const KeyframeAnimation* animation = getAnimationLibrary().get(cue.animation);
+    NotifierBase& notifier = *cue.notifier;
+    const TimeSource& notifierClock = notifier.clock();
     
-    // If we're already past the next keyframe time, return 0
-    if (effectiveTime >= nextKeyTime) {
-        return 0;
+    // Time the animation from when the cue was due, on the notifier's clock
+    unsigned long ticksPerMs = clock().ticksPerMs;
+    if (notifierClock.ticksPerMs != ticksPerMs) {
+        late = late / ticksPerMs * notifierClock.ticksPerMs +
+               late % ticksPerMs * notifierClock.ticksPerMs / ticksPerMs;
     }
-    
-    // Calculate time remaining to next keyframe
-    return nextKeyTime - effectiveTime;
+    notifier.startCue(animation, cue.mode, cue.blendTime, notifierClock.now() - late);
 }
 
-unsigned long LEDNotifier::timeRemaining() const {
-    if (currentState != PLAYING || currentAnimation == nullptr) {
-        return 0;
+unsigned long Timeline::timeToNextCue() const {
+    return timeToNextCue(clock().now());
+}
+
+unsigned long Timeline::timeToNextCue(unsigned long now) const {
+    if (!running || nextCue >= static_cast<int>(cues.size())) {
+        return NO_CHANGE;
     }
-    
-    if (currentAnimation->getKeyframeCount() < 1) {
+    unsigned long ticksPerMs = clock().ticksPerMs;
+    unsigned long sinceBase = static_cast<long>(now - baseTick) < 0 ? 0 : now - baseTick;
+    unsigned long ms = baseMs + sinceBase / ticksPerMs;
+    if (cues[nextCue].time <= ms) {
         return 0;
     }
-    
-    // For looping animations, there's no true "end"
-    if (currentMode == PLAY_LOOP || currentMode == PLAY_BOOMERANG) {
-        // Return time to complete current cycle
-        unsigned long currentTime = millis();
-        unsigned long effectiveTime = currentTime - startTime - totalPausedTime;
-        
-        unsigned long animationDuration = currentAnimation->getKeyFrameTime(
-            currentAnimation->getKeyframeCount() - 1
-        ) * globalSpeed;
-        
-        if (isReversing && currentMode == PLAY_BOOMERANG) {
-            // For boomerang in reverse direction, calculate time to get back to the start
-            return animationDuration - (effectiveTime % animationDuration);
-        } else {
-            // For regular loop or boomerang in forward direction
-            return animationDuration - (effectiveTime % animationDuration);
-        }
+    unsigned long remaining = cues[nextCue].time - ms;
+    if (remaining >= NO_CHANGE / ticksPerMs) {
+        return NO_CHANGE - 1;   // Further off than the clock can count
     }
-    
-    // For PLAY_ONCE mode
-    unsigned long currentTime = millis();
-    unsigned long effectiveTime = currentTime - startTime - totalPausedTime;
-    
-    unsigned long animationDuration = currentAnimation->getKeyFrameTime(
-        currentAnimation->getKeyframeCount() - 1
-    ) * globalSpeed;
-    
-    // If we're already past the end, return 0
-    if (effectiveTime >= animationDuration) {
+    return remaining * ticksPerMs - sinceBase % ticksPerMs;
+}
+
+bool Timeline::isRunning() const {
+    return running;
+}
+
+bool Timeline::isFinished() const {
+    return running && nextCue >= static_cast<int>(cues.size());
+}
+
+int Timeline::getCueCount() const {
+    return cues.size();
+}
+
+int Timeline::getNextCue() const {
+    return nextCue;
+}
+
+unsigned long Timeline::getCueTime(int index) const {
+    if (index < 0 || index >= static_cast<int>(cues.size())) {
         return 0;
     }
-    
-    // Calculate time remaining to the end
-    return animationDuration - effectiveTime;
+    return cues[index].time;
 }
 
 //======================================================================
 // RGBKeyframeAnimation Implementation
 //======================================================================
 
-RGBKeyframeAnimation::RGBKeyframeAnimation(const String& name) : name(name) {
+RGBKeyframeAnimation::RGBKeyframeAnimation(const String& name) : animation(name) {
     // Initialize with empty keyframe list
 }
 
 void RGBKeyframeAnimation::addKeyFrame(byte r, byte g, byte b, unsigned long time) {
-    RGBKeyframe newFrame = {r, g, b, time};
-    keyframes.push_back(newFrame);
+    animation.addColorKeyFrame(packColor(r, g, b), time);
 }
 
 bool RGBKeyframeAnimation::setKeyFrameColor(int index, byte r, byte g, byte b) {
-    if (index < 0 || index >= keyframes.size()) {
-        return false;
-    }
-    keyframes[index].red = r;
-    keyframes[index].green = g;
-    keyframes[index].blue = b;
-    return true;
+    return animation.setKeyFrameColor(index, packColor(r, g, b));
 }
 
 bool RGBKeyframeAnimation::setKeyFrameTime(int index, unsigned long newTime) {
-    if (index < 0 || index >= keyframes.size()) {
-        return false;
-    }
-    keyframes[index].time = newTime;
-    return true;
+    return animation.setKeyFrameTime(index, newTime);
 }
 
 int RGBKeyframeAnimation::getKeyframeCount() const {
-    return keyframes.size();
+    return animation.getKeyframeCount();
 }
 
 const String& RGBKeyframeAnimation::getName() const {
-    return name;
+    return animation.getName();
 }
 
 void RGBKeyframeAnimation::getKeyFrameColor(int index, byte& r, byte& g, byte& b) const {
-    if (index < 0 || index >= keyframes.size()) {
-        r = g = b = 0;
+    uint32_t color = animation.getKeyFrameColor(index);
+    r = color >> 16;
+    g = color >> 8;
+    b = color;
+}
+
+unsigned long RGBKeyframeAnimation::getKeyFrameTime(int index) const {
+    return animation.getKeyFrameTime(index);
+}
+
+const KeyframeAnimation& RGBKeyframeAnimation::getAnimation() const {
+    return animation;
+}
+
+//======================================================================
+// RGBNotifier Implementation
+//======================================================================
+
+RGBNotifier::RGBNotifier()
+    : redPin(-1),
+      greenPin(-1),
+      bluePin(-1),
+      color(0) {
+    playsColors = true;
+}
+
+RGBNotifier::RGBNotifier(int redPin, int greenPin, int bluePin)
+    : redPin(redPin),
+      greenPin(greenPin),
+      bluePin(bluePin),
+      color(0) {
+    playsColors = true;
+}
+
+void RGBNotifier::begin() {
+    if (redPin < 0) {
+        return;
+    }
+    pinMode(redPin, OUTPUT);
+    pinMode(greenPin, OUTPUT);
+    pinMode(bluePin, OUTPUT);
+}
+
+AnimationId RGBNotifier::addAnimation(const RGBKeyframeAnimation& animation) {
+    return NotifierBase::addAnimation(animation.getAnimation());
+}
+
+void RGBNotifier::playAnimation(const RGBKeyframeAnimation& animation, PlayMode mode) {
+    NotifierBase::playAnimation(animation.getAnimation(), mode);
+}
+
+void RGBNotifier::crossfadeTo(const RGBKeyframeAnimation& animation, unsigned long blendTime, PlayMode mode) {
+    NotifierBase::crossfadeTo(animation.getAnimation(), blendTime, mode);
+}
+
+bool RGBNotifier::playAt(const RGBKeyframeAnimation& animation, const WallClock& clock, unsigned long epochSeconds,
+                         PlayMode mode) {
+    return NotifierBase::playAt(animation.getAnimation(), clock, epochSeconds, mode);
+}
+
+void RGBNotifier::update() {
+    update(clock().now());
+}
+
+void RGBNotifier::update(unsigned long now) {
+    if (!advance(now)) {
         return;
     }
-    r = keyframes[index].red;
-    g = keyframes[index].green;
-    b = keyframes[index].blue;
-}
\ No newline at end of file
+    color = calculateColor();
+    
+    if (redPin >= 0 && takeLevel(color)) {
+        analogWrite(redPin, getRed());
+        analogWrite(greenPin, getGreen());
+        analogWrite(bluePin, getBlue());
+    }
+    deliverEvents();
+}
+
+uint32_t RGBNotifier::calculateColor() const {
+    // The engine's value is a fractional keyframe index
+    if (isBlending && targetAnimation != nullptr) {
+        return blendColor();
+    }
+    return currentAnimation->colorAt(currentValue);
+}
+
+uint32_t RGBNotifier::getColor() const {
+    return color;
+}
+
+byte RGBNotifier::getRed() const {
+    return color >> 16;
+}
+
+byte RGBNotifier::getGreen() const {
+    return color >> 8;
+}
+
+byte RGBNotifier::getBlue() const {
+    return color;
+}
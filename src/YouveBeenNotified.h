@@ -29,95 +29,712 @@ enum AnimationState {
     COMPLETED
 };
 
+// Shape of the motion into a keyframe from the one before it
+enum Easing {
+    LINEAR,        // Constant speed
+    STEP,          // Hold the previous value, then jump
+    EASE_IN,       // Start slow
+    EASE_OUT,      // Arrive slow
+    EASE_IN_OUT,   // Start and arrive slow
+    BEZIER,        // Cubic Bezier, see setKeyFrameBezier()
+    CATMULL_ROM    // Smooth curve through the neighbouring keyframes
+};
+
 // LED operation mode
 enum LEDMode {
     ANALOG,   // PWM output (0-255)
     DIGITAL   // On/Off (0=OFF, 1=ON)
 };
 
+// ----------------------------------------------------------------
+// TimeSource
+// The clock a notifier reads once per update(). now() returns ticks
+// and ticksPerMs converts keyframe times (always in ms) to those ticks
+// ----------------------------------------------------------------
+struct TimeSource {
+    unsigned long (*now)();
+    unsigned long ticksPerMs;
+};
+
+// Ready-made clocks
+static const TimeSource MILLIS_CLOCK = {millis, 1};
+static const TimeSource MICROS_CLOCK = {micros, 1000};   // Sub-millisecond timing
+
+// Clock used by every notifier that has not been given its own
+void setDefaultTimeSource(const TimeSource& source);
+const TimeSource& getDefaultTimeSource();
+
+// ----------------------------------------------------------------
+// WallClock Class
+// Time of day for playAt(), from an RTC or any other source of epoch
+// seconds. The ms within each second come from a TimeSource, kept in
+// line with the seconds by update(), so boards that share a wall time
+// play scheduled animations in step without talking to each other
+// ----------------------------------------------------------------
+class WallClock {
+private:
+    unsigned long (*readSeconds)();   // Epoch seconds, e.g. the RTC's Unix time
+    TimeSource timeSource;            // now == nullptr: use the default clock
+    unsigned long baseSeconds;        // Wall time at baseTick
+    long baseMillis;
+    unsigned long baseTick;
+    unsigned long lastSeconds;        // Reading at the last update()
+    bool started;
+    bool synced;                      // A change of second has been seen
+    
+    const TimeSource& clock() const;
+    void setBase(unsigned long seconds, long millis, unsigned long tick);
+
+public:
+    explicit WallClock(unsigned long (*epochSeconds)());
+    
+    // Clock for the ms between seconds (defaults to getDefaultTimeSource())
+    void setTimeSource(const TimeSource& source);
+    
+    // Wait for the seconds to change, which pins down ms 0. Blocks for
+    // up to timeoutMs; returns false if they never changed
+    bool sync(unsigned long timeoutMs = 1100);
+    
+    // Read the seconds and correct the ms to match. Call every loop();
+    // without sync() the ms settle on the first change of second
+    void update();
+    
+    bool isSynced() const;
+    
+    // Wall time since epochSeconds: whole seconds, negative before it,
+    // plus ms (0 to 999) into the second. Good for 68 years either side
+    long secondsSince(unsigned long epochSeconds, int& ms) const;
+    
+    // The same in ms. Good for about 24 days either side
+    long msSince(unsigned long epochSeconds) const;
+};
+
+// ----------------------------------------------------------------
+// Evaluation number format
+// Build with YBN_FIXED_POINT=1 (compiler flag, or change the default
+// below) to evaluate animations in Q16.16 integers on boards without
+// an FPU. Values must then stay within +/-32767 and keyframe times
+// under 16,777,215 ms.
+// ----------------------------------------------------------------
+#ifndef YBN_FIXED_POINT
+#define YBN_FIXED_POINT 0
+#endif
+
+typedef int32_t fixed_t;   // Q16.16
+
+// Saturates outside the Q16.16 range, so +/-INFINITY map to the limits
+inline fixed_t toFixed(float value) {
+    if (value >= 32767.0f) {
+        return INT32_MAX;
+    }
+    if (value <= -32768.0f) {
+        return INT32_MIN;
+    }
+    return value >= 0 ? value * 65536.0f + 0.5f : value * 65536.0f - 0.5f;
+}
+
+inline float fromFixed(fixed_t value) {
+    return value / 65536.0f;
+}
+
+#if YBN_FIXED_POINT
+typedef fixed_t sample_t;      // Animation values, Q16.16
+typedef uint32_t position_t;   // Animation time in ms, Q24.8
+
+static const sample_t SAMPLE_MIN = INT32_MIN;
+static const sample_t SAMPLE_MAX = INT32_MAX;
+
+inline sample_t toSample(float value) { return toFixed(value); }
+inline float fromSample(sample_t value) { return fromFixed(value); }
+inline sample_t mulSample(sample_t a, sample_t b) { return (static_cast<int64_t>(a) * b) >> 16; }
+inline int roundSample(sample_t value) { return (value + 0x8000) >> 16; }
+
+// Fraction part / whole as a sample (0 to 1)
+inline sample_t ratioSample(unsigned long part, unsigned long whole) {
+    return (static_cast<uint64_t>(part) << 16) / whole;
+}
+#else
+typedef float sample_t;
+typedef float position_t;
+
+static const sample_t SAMPLE_MIN = -INFINITY;
+static const sample_t SAMPLE_MAX = INFINITY;
+
+inline sample_t toSample(float value) { return value; }
+inline float fromSample(sample_t value) { return value; }
+inline sample_t mulSample(sample_t a, sample_t b) { return a * b; }
+inline int roundSample(sample_t value) { return round(value); }
+
+inline sample_t ratioSample(unsigned long part, unsigned long whole) {
+    return static_cast<float>(part) / whole;
+}
+#endif
+
+class NotifierGroup;
+class Timeline;
+class RGBNotifier;
+
+// ----------------------------------------------------------------
+// Keyframe tables
+// A constant array of keyframes that an animation plays in place.
+// Declare it PROGMEM so it stays in flash on AVR boards:
+//   constexpr Keyframe waveFrames[] PROGMEM = {{0, 0}, {90, 500}, {0, 1000}};
+//   KeyframeAnimation wave("wave", waveFrames);
+// ----------------------------------------------------------------
+struct Keyframe {
+    float value;
+    unsigned long time;
+};
+
+#ifndef PROGMEM
+#define PROGMEM   // Boards without separate flash reads use plain const data
+#endif
+
 // ----------------------------------------------------------------
 // KeyframeAnimation Class
 // Stores a sequence of value/time keyframes
+// Kept in playback-ready form: parallel arrays of times, values and
+// per-segment slopes, updated as keyframes are added or edited
 // ----------------------------------------------------------------
 class KeyframeAnimation {
 private:
     String name;
-    struct Keyframe {
-        float value;
-        unsigned long time;
+    uint32_t nameHash;            // Compared before the name in lookups
+    std::vector<unsigned long> times;
+    std::vector<float> values;
+    std::vector<float> slopes;    // Value change per ms from keyframe i to i+1
+#if YBN_FIXED_POINT
+    std::vector<fixed_t> fixedValues;
+    std::vector<int64_t> fixedSlopes;   // Q32.32 per ms, so long segments do not drift
+#endif
+    std::vector<uint32_t> colors; // Packed 0xRRGGBB per keyframe, colour animations only
+    
+    // Curved segments, value = start + u * (c1 + u * (c2 + u * c3)) with
+    // u going from 0 to 1 across the segment. Filled in by updateSlope()
+    struct SegmentCurve {
+        float c1, c2, c3;
+        float rate;               // u per ms
+#if YBN_FIXED_POINT
+        fixed_t fixedC1, fixedC2, fixedC3;
+        uint32_t fixedRate;       // u per ms, in 1/2^32
+#endif
     };
-    std::vector<Keyframe> keyframes;
+    
+    // Per keyframe, empty until an easing other than LINEAR is used
+    std::vector<uint8_t> easings;
+    std::vector<float> bezierControls;   // Two per keyframe
+    std::vector<SegmentCurve> curves;
+    const Keyframe* table;        // Constant keyframes used in place of the arrays above
+    int tableCount;
+    std::vector<sample_t> baked;  // Values at fixed steps, see bake()
+    unsigned long bakeStep;       // ms between baked values, 0 if not baked
+    bool bakeInterpolate;
+#if YBN_FIXED_POINT
+    uint8_t bakeShift;            // bakeStep is 1 << bakeShift
+#else
+    float bakeRate;               // Baked values per ms
+#endif
+    
+    void updateSlope(int segment);
+    void updateSlopesAround(int index);
+    bool isSimplifyAnchor(int index) const;
+    float segmentValue(int segment, float time) const;
+    bool segmentExit(int segment, float from, float to, float low, float high, float& exit) const;
+    void useEasings();
+    bool isCurved(int segment) const {
+        return !easings.empty() && easings[segment + 1] >= EASE_IN;
+    }
+    template <typename Time>
+    int findSegmentAt(Time time, int hint) const;
+    float tableValueAt(float time, int& segment) const;
+#if YBN_FIXED_POINT
+    sample_t tableSampleAt(position_t time, int& segment) const;
+#endif
+    sample_t bakedSampleAt(position_t time, int& segment) const;
 
 public:
     // Constructor with optional name
     KeyframeAnimation(const String& name = "");
     
-    // Add a keyframe with value and time to reach it
-    void addKeyFrame(float value, unsigned long time);
+    // Play keyframes straight from a constant table (see Keyframe)
+    // without copying them to RAM. The table must outlive the animation,
+    // and its keyframes cannot be added to or changed
+    KeyframeAnimation(const String& name, const Keyframe* table, int count);
+    template <int N>
+    KeyframeAnimation(const String& name, const Keyframe (&table)[N])
+        : KeyframeAnimation(name, table, N) {}
+    
+    // Add a keyframe with value and time to reach it, and how to move
+    // there from the previous keyframe
+    void addKeyFrame(float value, unsigned long time, Easing easing = LINEAR);
+    
+    // Allocate room for keyframeCount keyframes up front
+    void reserve(int keyframeCount);
     
     // Dynamically modify keyframe values
     bool setKeyFrameValue(int index, float newValue);
     bool setKeyFrameTime(int index, unsigned long newTime);
     
+    // Easing into a keyframe. Curves are worked out here, so playback
+    // costs a few multiplies whatever the easing. Keyframe tables are
+    // always linear
+    bool setKeyFrameEasing(int index, Easing easing);
+    Easing getKeyFrameEasing(int index) const;
+    
+    // BEZIER easing with two control points given as fractions of the
+    // change in value: 0 is the previous keyframe's value, 1 this one's.
+    // (0, 1) matches EASE_IN_OUT; values outside 0-1 overshoot
+    bool setKeyFrameBezier(int index, float control1, float control2);
+    
+    // Remove keyframes within tolerance of the line between their
+    // neighbours (Ramer-Douglas-Peucker), for thinning out sampled motion.
+    // Returns the number removed; maxError receives the largest change.
+    // Keeps eased keyframes, Catmull-Rom neighbours and instant jumps,
+    // and leaves tables and colour animations alone. Meant for setup()
+    int simplify(float tolerance, float* maxError = nullptr);
+    
     // Utility methods
     int getKeyframeCount() const;
     const String& getName() const;
+    uint32_t getNameHash() const;
     float getKeyFrameValue(int index) const;
     unsigned long getKeyFrameTime(int index) const;
+    
+    // Index of the keyframe that starts the segment containing time (ms).
+    // hint is the previous result: sequential playback is O(1), jumps
+    // (loop wraps, speed changes) fall back to an O(log n) search
+    int findSegment(float time, int hint = 0) const;
+    
+    // Interpolated value at time (ms). segment is the lookup cursor and
+    // is updated to the segment that was used
+    float valueAt(float time, int& segment) const;
+    
+    // Same as valueAt() in the engine's number format (see YBN_FIXED_POINT)
+    sample_t sampleAt(position_t time, int& segment) const;
+    
+    // Values at count evenly spaced times t0, t0 + dt, ... (ms) written
+    // to out, for previews, lookup tables or DMA buffers. Each segment
+    // is filled in one straight loop, which compilers can vectorize.
+    // The int version rounds to the nearest whole number
+    void sampleRange(float t0, float dt, int count, float* out) const;
+    void sampleRange(float t0, float dt, int count, int* out) const;
+    sample_t getKeyFrameSample(int index) const;
+    
+    // Render the curve into a lookup table with one value every stepMs,
+    // so playback reads the table instead of interpolating. Fails, leaving
+    // the animation unbaked, if the table would need more than maxEntries
+    // values. interpolate blends the two nearest values instead of taking
+    // the closest one. Fixed-point builds round stepMs down to a power of
+    // two. Changing a keyframe drops the table
+    bool bake(unsigned long stepMs = 1, int maxEntries = 1024, bool interpolate = false);
+    void unbake();
+    bool isBaked() const;
+    unsigned long getBakedBytes() const;  // Memory used by the table
+    
+    // Time of the last keyframe (ms)
+    unsigned long getDuration() const;
+    
+    // Animation ms until the value first leaves low (inclusive) to high
+    // (exclusive), played from time from towards time to in either
+    // direction. Negative if it stays inside. Used by the wake-up queries
+    float timeUntilOutside(float from, float to, float low, float high) const;
+    
+    // Colour keyframes (see RGBKeyframeAnimation). The keyframe value is
+    // the keyframe's index, so the interpolated value tells colorAt()
+    // which two colours to mix and by how much
+    void addColorKeyFrame(uint32_t color, unsigned long time);
+    bool setKeyFrameColor(int index, uint32_t color);
+    uint32_t getKeyFrameColor(int index) const;
+    bool hasColors() const;
+    uint32_t colorAt(sample_t index) const;
+    
+    // True if both hold the same keyframe times, values and easings,
+    // baked the same way
+    bool hasSameKeyframes(const KeyframeAnimation& other) const;
+    
+    // True if the keyframes are read from a constant table
+    bool hasKeyframeTable() const;
 };
 
+// Packed 0xRRGGBB colours
+inline uint32_t packColor(byte r, byte g, byte b) {
+    return (static_cast<uint32_t>(r) << 16) | (static_cast<uint32_t>(g) << 8) | b;
+}
+
+// Mix two packed colours, weight 0 (all from) to 256 (all to). Red and
+// blue are mixed together in one multiply, green in another
+inline uint32_t lerpColor(uint32_t from, uint32_t to, uint16_t weight) {
+    uint16_t keep = 256 - weight;
+    uint32_t redBlue = ((from & 0xFF00FFUL) * keep + (to & 0xFF00FFUL) * weight) >> 8;
+    uint32_t green = ((from & 0x00FF00UL) * keep + (to & 0x00FF00UL) * weight) >> 8;
+    return (redBlue & 0xFF00FFUL) | (green & 0x00FF00UL);
+}
+
+// Hash used to compare animation names without a String compare
+uint32_t hashAnimationName(const String& name);
+
+// Index of an animation in the AnimationLibrary. IDs never change once
+// assigned, so playing by ID is a direct lookup
+typedef int AnimationId;
+static const AnimationId NO_ANIMATION = -1;
+
 // ----------------------------------------------------------------
-// ServoNotifier Class
-// Controls servo movements using animations
+// AnimationLibrary Class
+// Owns one copy of each animation added to a notifier, shared by
+// every notifier that uses it. Entries are never moved, so notifiers
+// can keep pointers to them as the library grows
 // ----------------------------------------------------------------
-class ServoNotifier {
+class AnimationLibrary {
 private:
+    std::vector<KeyframeAnimation*> entries;
+    
+    AnimationLibrary(const AnimationLibrary&) = delete;
+    AnimationLibrary& operator=(const AnimationLibrary&) = delete;
+
+public:
+    AnimationLibrary();
+    ~AnimationLibrary();
+    
+    // Allocate room for animationCount entries up front
+    void reserve(int animationCount);
+    
+    // Returns the ID of the stored copy of animation. An animation with
+    // the same name and keyframes as an existing entry is not stored again
+    AnimationId add(const KeyframeAnimation& animation);
+    
+    // Stored animation for an ID (nullptr if there is none)
+    const KeyframeAnimation* get(AnimationId id) const;
+    
+    // Most recently added animation with this name, or NO_ANIMATION.
+    // Meant for setup(); play by ID in loop()
+    AnimationId find(const String& name) const;
+    
+    // Status methods
+    int getCount() const;           // Animations stored
+    long getKeyframeCount() const;  // Keyframes stored in RAM across all animations
+    unsigned long getBakedBytes() const;  // Baked tables across all animations
+};
+
+// Library used by every notifier's addAnimation()
+AnimationLibrary& getAnimationLibrary();
+
+// ----------------------------------------------------------------
+// OutputSink Class
+// Channel levels for hardware that takes many channels in one
+// transaction, such as I2C PWM expanders or shift registers. Notifiers
+// set() levels as they update, then flush() sends every changed
+// channel in a single send(), once per frame. Derive from it and
+// implement send() for the hardware
+// ----------------------------------------------------------------
+class OutputSink {
+private:
+    std::vector<uint16_t> levels;
+    int firstChanged;     // Range of changed channels, -1 if none
+    int lastChanged;
+    unsigned long transactionCount;
+    
+    OutputSink(const OutputSink&) = delete;
+    OutputSink& operator=(const OutputSink&) = delete;
+
+protected:
+    // Send the levels of channels first to first + count - 1 in one
+    // transaction. Unchanged channels inside the range are sent too
+    virtual void send(int first, int count, const uint16_t* levels) = 0;
+
+public:
+    explicit OutputSink(int channelCount);
+    virtual ~OutputSink() {}
+    
+    // Level for a channel, sent on the next flush() if it changed
+    void set(int channel, uint16_t level);
+    uint16_t get(int channel) const;
+    
+    // Send the changed channels. Returns true if anything was sent
+    bool flush();
+    
+    // Send every channel on the next flush(), e.g. after a hardware reset
+    void resendAll();
+    
+    // Status methods
+    int getChannelCount() const;
+    unsigned long getTransactionCount() const;   // send() calls so far
+};
+
+inline void OutputSink::set(int channel, uint16_t level) {
+    if (channel < 0 || channel >= static_cast<int>(levels.size()) || levels[channel] == level) {
+        return;
+    }
+    levels[channel] = level;
+    if (firstChanged < 0 || channel < firstChanged) {
+        firstChanged = channel;
+    }
+    if (channel > lastChanged) {
+        lastChanged = channel;
+    }
+}
+
+// ----------------------------------------------------------------
+// Output policies
+// What a notifier does with its value after each update(). The
+// policy is a base class of Notifier, so write() is resolved at
+// compile time and inlined into update(). A new output type only
+// needs a class with level(int value), which turns the value into what
+// the hardware gets, and write(int level). write() is only called when
+// the level changes
+// ----------------------------------------------------------------
+
+// Leaves the value for the sketch to read with getValue()
+class ServoOutput {
+protected:
     Servo* servo;
     int minAngle;
     int maxAngle;
     
-    std::vector<KeyframeAnimation> animations;
-    KeyframeAnimation* currentAnimation;
-    KeyframeAnimation* targetAnimation;    // For blending
+    int level(int value) const { return value; }
+    void write(int) {}
+
+public:
+    ServoOutput(Servo* servo, int minAngle, int maxAngle);
+};
+
+// Writes the value to a PWM pin, or to a digital pin through a threshold
+class LEDOutput {
+protected:
+    int pin;
+    LEDMode mode;
+    float threshold;  // Threshold for digital mode (0.0-1.0)
+    
+    int level(int value) const;
+    void write(int level);
+
+public:
+    LEDOutput(int pin, LEDMode mode);
+    void begin();
+    
+    // Set mode after construction
+    void setMode(LEDMode newMode);
+    
+    // Set threshold for digital mode
+    void setThreshold(float newThreshold);
+};
+
+// Sets a channel of an OutputSink, which sends it on flush()
+class SinkOutput {
+protected:
+    OutputSink* sink;
+    int channel;
+    
+    int level(int value) const { return constrain(value, 0, 65535); }   // Channel levels are 16-bit
+    void write(int level) { sink->set(channel, level); }
+
+public:
+    SinkOutput(OutputSink* sink, int channel);
+    OutputSink& getSink() const;
+    int getChannel() const;
+};
+
+inline int LEDOutput::level(int value) const {
+    if (mode == ANALOG) {
+        // For analog (PWM) mode
+        return constrain(value, 0, 255);
+    }
+    // For digital (ON/OFF) mode - use threshold
+    return value >= threshold ? HIGH : LOW;
+}
+
+inline void LEDOutput::write(int level) {
+    if (mode == ANALOG) {
+        analogWrite(pin, level);
+    } else {
+        digitalWrite(pin, level);
+    }
+}
+
+// timeToNextChange() result when the output will not change on its own
+static const unsigned long NO_CHANGE = 0xFFFFFFFFUL;
+
+// Playback events, reported by update(). Also bits for the event mask
+enum NotifierEvent {
+    EVENT_KEYFRAME = 1,        // Reached a keyframe; detail is its index
+    EVENT_WRAP = 2,            // A LOOP or BOOMERANG pass ended; detail is the passes
+    EVENT_CROSSFADE_END = 4,   // The animation faded to now plays alone
+    EVENT_COMPLETE = 8,        // A PLAY_ONCE animation reached its end
+    EVENT_ALL = 15
+};
+
+class NotifierBase;
+
+// Called with the notifier, the event, its detail and the context
+// given to setEventCallback()
+typedef void (*NotifierCallback)(NotifierBase& notifier, NotifierEvent event, long detail, void* context);
+
+// ----------------------------------------------------------------
+// NotifierBase Class
+// The animation engine shared by every notifier type: playback,
+// blending, speed, pause/resume and timing queries. It is not a
+// template, so the engine is compiled once however many output types
+// are used
+// ----------------------------------------------------------------
+class NotifierBase {
+private:
+    // Place in a NotifierGroup. It belongs to this object: copies start
+    // outside any group, and assignment keeps the group it had
+    struct GroupMembership {
+        NotifierGroup* group;
+        int slot;
+        
+        GroupMembership() : group(nullptr), slot(-1) {}
+        GroupMembership(const GroupMembership&) : group(nullptr), slot(-1) {}
+        GroupMembership& operator=(const GroupMembership&) { return *this; }
+    };
+    
+    std::vector<AnimationId> animations;   // Entries in getAnimationLibrary()
+    bool playsColors;            // Set by RGBNotifier, which plays colour animations only
+    const KeyframeAnimation* currentAnimation;
+    const KeyframeAnimation* targetAnimation;    // For blending
+    const WallClock* wallClock;  // Set by playAt(), with the scheduled time
+    unsigned long scheduledAt;   // Epoch seconds
+    bool startsLater;            // Holding the first keyframe until startTime
     PlayMode currentMode;
     AnimationState currentState;
     float globalSpeed;
+    TimeSource timeSource;   // now == nullptr: use the default clock
+    GroupMembership membership;   // Group that updates this notifier, if any
+#if YBN_FIXED_POINT
+    uint32_t tickScale;      // Q24.8 animation ms per clock tick = tickScale >> tickShift
+    uint8_t tickShift;
+#else
+    float tickScale;         // Animation ms per clock tick (globalSpeed / ticksPerMs)
+    float tickScaleLow;      // Rounding left out of tickScale
+#endif
     
-    // Timing and state tracking
+    // Timing and state tracking. A wrap moves startTime to the frame it
+    // happened in and carries the overshoot in phase, so loops keep time
     unsigned long startTime;
+    position_t phase;         // Position in the current pass at startTime
+#if YBN_FIXED_POINT
+    uint64_t phaseFraction;   // Below phase's resolution, in 1/2^tickShift
+#else
+    float phaseFraction;      // What float rounding left out of phase, in ms
+#endif
     unsigned long pauseTime;
     unsigned long totalPausedTime;
     int currentKeyframeIndex;
     int nextKeyframeIndex;
-    float currentValue;
+    sample_t currentValue;
     bool isReversing;
     bool isPlayingBackward;
     
     // Value adjustment properties
-    float valueScale;     // Multiplier for final value
-    float valueOffset;    // Added to final value
-    float minValue;       // Output clamping minimum
-    float maxValue;       // Output clamping maximum
+    sample_t valueScale;  // Multiplier for final value
+    sample_t valueOffset; // Added to final value
+    sample_t minValue;    // Output clamping minimum
+    sample_t maxValue;    // Output clamping maximum
     
-    // Blend control
+    // Blend control. Both animations play during a crossfade, each with
+    // its own segment cursor, and are mixed by blendWeight
     bool isBlending;
-    unsigned long blendStartTime;
+    unsigned long blendStartTime;  // Also when the target started playing
     unsigned long blendDuration;
-    float startValue;     // Value at blend start
+    PlayMode targetMode;
+    int targetKeyframeIndex;  // Segment cursor into targetAnimation
+    sample_t outgoingValue;   // Values of both animations at the last update
+    sample_t targetValue;
+    sample_t blendWeight;     // Blend progress, 0 to 1
+    uint32_t heldColor;       // Colour of the held mix, for RGB animations
+    bool holdOutgoing;        // Fading from a mix held at outgoingValue
+    
+    // Change tracking, per notifier
+    int changeValue;              // getValue() at the last hasChanged()
+    long writtenLevel;            // Last level written to the output
+    unsigned long skippedWrites;  // Updates that left the output level as it was
+    
+    // Events: the callback, and what the last advance() has to report
+    NotifierCallback eventCallback;
+    void* eventContext;
+    uint8_t eventMask;
+    uint8_t eventFlags;           // EVENT_CROSSFADE_END and EVENT_COMPLETE bits
+    uint8_t eventSerial;          // Changed by every play, crossfade, seek and stop
+    bool eventsPending;
+    bool eventFromReversing;      // Cursor and direction before the update
+    int eventFromKeyframe;
+    unsigned long wrapPasses;     // Passes wrapped during the update
     
     // Internal methods
-    float interpolateValue(float startVal, float endVal, float t);
-    float calculateCurrentValue();
+    sample_t interpolateValue(sample_t startVal, sample_t endVal, sample_t t);
+    sample_t calculateCurrentValue(unsigned long now);
+    void startAnimation(const KeyframeAnimation* animation, PlayMode mode, unsigned long now);
+    const KeyframeAnimation* resolveAnimation(const KeyframeAnimation& animation);
+    bool canPlay(const KeyframeAnimation* animation) const;
+    void beginCrossfade(const KeyframeAnimation* target, unsigned long blendTime, PlayMode mode,
+                        unsigned long startedAt);
+    void startCue(const KeyframeAnimation* animation, PlayMode mode, unsigned long blendTime,
+                  unsigned long startedAt);
+    void promoteTarget();
+    uint32_t blendColor() const;
+    void jumpTo(position_t position, bool reversing);
+    bool scheduleAnimation(const KeyframeAnimation* animation, const WallClock& clock, unsigned long epochSeconds,
+                           PlayMode mode);
+    position_t targetPosition(unsigned long elapsed, bool& reversing) const;
+    void updateTickScale();
+    unsigned long toTicks(unsigned long ms) const;
+    position_t toPosition(unsigned long ticks) const;
+    bool getOutputBounds(float& low, float& high) const;
+    float timeToLeave(const KeyframeAnimation* animation, PlayMode mode, float position, bool reversing,
+                      float low, float high) const;
+    float playbackPosition(unsigned long now, bool& reversing) const;
+    unsigned long passTicks(unsigned long now) const;
+    unsigned long timeToLeaveBlend(unsigned long now, float low, float high, float tickRate) const;
+    unsigned long markBlendEnd();
+    void queueEvents();
+    void fireEvents();
+    bool fireKeyframes(int from, int to, bool reversing, uint8_t serial);
+    bool fireEvent(NotifierEvent event, long detail, uint8_t serial);
+    
+    friend class NotifierGroup;
+    friend class RGBNotifier;
+    friend class Timeline;
 
-public:
-    // New constructor that doesn't require a Servo object
-    ServoNotifier(int minAngle = 0, int maxAngle = 180);
+protected:
+    NotifierBase();
+    ~NotifierBase();   // Leaves its group
+    NotifierBase(const NotifierBase&) = default;
+    NotifierBase(NotifierBase&&) = default;
+    NotifierBase& operator=(const NotifierBase&) = default;
+    NotifierBase& operator=(NotifierBase&&) = default;
     
-    // Original constructor
-    ServoNotifier(Servo& servo, int minAngle = 0, int maxAngle = 180);
+    // Advance the animation to now. Returns false if nothing is playing
+    bool advance(unsigned long now);
+    const TimeSource& clock() const;
+    
+    // True if level differs from the last one written, which it then
+    // becomes. Unchanged levels are counted as skipped writes
+    bool takeLevel(long level) {
+        if (level == writtenLevel) {
+            skippedWrites++;
+            return false;
+        }
+        writtenLevel = level;
+        return true;
+    }
+    
+    // Make the next update() write whatever the level
+    void invalidateLevel();
     
-    // Animation management
-    void addAnimation(const KeyframeAnimation& animation);
+    // Report the events of the last advance(). Call once the output is
+    // written, as the callback may start something else
+    void deliverEvents() {
+        if (eventsPending) {
+            fireEvents();
+        }
+    }
+
+public:
+    // Animation management (returns the animation's ID)
+    AnimationId addAnimation(const KeyframeAnimation& animation);
+    
+    // ID of an added animation by name, or NO_ANIMATION
+    AnimationId getAnimationId(const String& name) const;
     
     // Play animation by reference
     void playAnimation(const KeyframeAnimation& animation, PlayMode mode = PLAY_ONCE);
@@ -125,9 +742,32 @@ public:
     // Play animation by name
     bool playAnimation(const String& name, PlayMode mode = PLAY_ONCE);
     
+    // Play animation by ID (no name lookup). IDs are shared, so one added
+    // by any notifier plays here too, without being added to this one.
+    // Returns false for an unknown ID or the wrong kind: colour
+    // animations on RGBNotifier only
+    bool playAnimation(AnimationId id, PlayMode mode = PLAY_ONCE);
+    
+    // Play an animation as if it started at epochSeconds by the wall
+    // clock. A time in the past joins it partway through; a time in the
+    // future holds the first keyframe until then. Notifiers scheduled
+    // for the same time stay in step, on any board
+    bool playAt(const KeyframeAnimation& animation, const WallClock& clock, unsigned long epochSeconds,
+                PlayMode mode = PLAY_ONCE);
+    bool playAt(const String& name, const WallClock& clock, unsigned long epochSeconds,
+                PlayMode mode = PLAY_ONCE);
+    bool playAt(AnimationId id, const WallClock& clock, unsigned long epochSeconds,
+                PlayMode mode = PLAY_ONCE);
+    
+    // Put a playAt() animation back where the wall clock says it should
+    // be, undoing drift between this board's clock and the RTC. Call now
+    // and then, e.g. once a minute. Returns false without a schedule
+    bool syncToWallClock();
+    
     // Enhanced transition methods
     void crossfadeTo(const KeyframeAnimation& animation, unsigned long blendTime, PlayMode mode = PLAY_ONCE);
     bool crossfadeTo(const String& name, unsigned long blendTime, PlayMode mode = PLAY_ONCE);
+    bool crossfadeTo(AnimationId id, unsigned long blendTime, PlayMode mode = PLAY_ONCE);
     
     // Value adjustment methods
     void setValueScale(float scale);
@@ -139,21 +779,45 @@ public:
     void resume();
     void stop();
     
-    // Update animation state and calculate new value
-    void update();
+    // Jump to ms of playback on the animation's timeline, as if it had
+    // played that long from the start. Loops and boomerangs fold it into
+    // the pass it falls in. Ends any crossfade, and restarts a completed
+    // animation. Returns false if nothing is playing
+    bool seek(unsigned long ms);
+    
+    // Jump to a fraction (0 to 1) of the animation, playing forward.
+    // 1 is the end, folded like seek(getTotalDuration())
+    bool seekNormalized(float fraction);
     
     // Get the current interpolated and adjusted value as an integer
     int getValue() const;
     
-    // Check if the value has changed since last getValue() call
+    // Check if the value has changed since this notifier's last
+    // hasChanged() call
     bool hasChanged();
     
+    // Updates that did not write to the output because its level was
+    // unchanged
+    unsigned long getSkippedWrites() const;
+    
+    // Call callback from update() for each event in events (NotifierEvent
+    // bits): every keyframe reached, in order, however many one update
+    // passes; each wrap, with the passes it covered (keyframes of whole
+    // passes skipped in one update are not repeated); the end of a
+    // crossfade, and completion. Nothing is reported during a crossfade,
+    // and seek() and the play methods move without events. Each event is
+    // delivered once, after the output is written. nullptr removes it
+    void setEventCallback(NotifierCallback callback, void* context = nullptr, uint8_t events = EVENT_ALL);
+    
     // Speed control
     void setGlobalSpeed(float speed);
     float getGlobalSpeed() const;
     
+    // Clock control (defaults to getDefaultTimeSource())
+    void setTimeSource(const TimeSource& source);
+    
     // Status methods
-    String getCurrentAnimationName() const;
+    const String& getCurrentAnimationName() const;
     bool isPlaying() const;
     bool isPaused() const;
     bool isCompleted() const;
@@ -161,122 +825,248 @@ public:
     bool isBlendingAnimations() const;
     AnimationState getState() const;
     
-    // Timing methods
+    // Timing methods (results in ms, now in clock ticks)
     unsigned long timeToNextKey() const;
+    unsigned long timeToNextKey(unsigned long now) const;
     unsigned long timeRemaining() const;
+    unsigned long timeRemaining(unsigned long now) const;
     
-    // Missing functions from documentation
+    // Clock ticks until getValue() next changes, for sleeping between
+    // updates. Call right after update(). Values that round to the same
+    // output do not count. 0 if it may change now, NO_CHANGE if only a
+    // new play or resume call can change it
+    unsigned long timeToNextChange() const;
+    unsigned long timeToNextChange(unsigned long now) const;
+    
+    // Current animation and stored animations
     PlayMode getPlaybackMode() const;
     unsigned long getElapsedTime() const;
+    unsigned long getElapsedTime(unsigned long now) const;
     unsigned long getTotalDuration() const;
     float getStartValue() const;
     float getEndValue() const;
+    
+    // Animations added to this notifier; one played by another's ID is
+    // not among them
     bool hasAnimation(const String& name) const;
     int getAnimationCount() const;
-    std::vector<String> getAnimationNames() const;
+    const String& getAnimationName(int index) const;
+    std::vector<String> getAnimationNames() const;   // Allocates; prefer getAnimationName()
+};
+
+// ----------------------------------------------------------------
+// Notifier Class
+// NotifierBase joined to an output policy. Only update() depends on
+// the output, so each output type adds just that to the program
+// ----------------------------------------------------------------
+template <typename Output>
+class Notifier : public NotifierBase, public Output {
+protected:
+    explicit Notifier(const Output& output) : Output(output) {}
+
+public:
+    // Update animation state, calculate the new value and pass it to
+    // the output
+    void update() {
+        update(clock().now());
+    }
+    
+    // Use a timestamp already read from the clock
+    void update(unsigned long now) {
+        if (advance(now)) {
+            int level = Output::level(getValue());
+            if (takeLevel(level)) {
+                Output::write(level);
+            }
+            deliverEvents();
+        }
+    }
+};
+
+// ----------------------------------------------------------------
+// ServoNotifier Class
+// Controls servo movements using animations
+// ----------------------------------------------------------------
+class ServoNotifier : public Notifier<ServoOutput> {
+public:
+    // New constructor that doesn't require a Servo object
+    ServoNotifier(int minAngle = 0, int maxAngle = 180);
+    
+    // Original constructor
+    ServoNotifier(Servo& servo, int minAngle = 0, int maxAngle = 180);
 };
 
 // ----------------------------------------------------------------
 // LEDNotifier Class
-// Controls LED animations
+// Controls LED animations, writing the pin when its level changes
 // ----------------------------------------------------------------
-class LEDNotifier {
+class LEDNotifier : public Notifier<LEDOutput> {
+public:
+    LEDNotifier(int pin, LEDMode mode = ANALOG);
+    
+    // As on LEDOutput; the next update() then writes the pin again
+    void begin();
+    void setMode(LEDMode newMode);
+};
+
+// ----------------------------------------------------------------
+// SinkNotifier Class
+// Animates one channel of an OutputSink. Flush the sink after updating
+// its notifiers, or add them to a NotifierGroup, which flushes it once
+// per update()
+// ----------------------------------------------------------------
+class SinkNotifier : public Notifier<SinkOutput> {
+public:
+    SinkNotifier(OutputSink& sink, int channel);
+};
+
+// ----------------------------------------------------------------
+// NotifierGroup Class
+// Updates many notifiers from a single clock read per frame. Only
+// channels that are playing are visited, so idle, paused and completed
+// notifiers cost nothing per update.
+// ----------------------------------------------------------------
+class NotifierGroup {
 private:
-    int pin;
-    LEDMode mode;
-    float threshold;  // Threshold for digital mode (0.0-1.0)
+    enum ChannelKind : uint8_t {
+        SERVO_CHANNEL,
+        LED_CHANNEL,
+        SINK_CHANNEL,
+        RGB_CHANNEL
+    };
     
-    std::vector<KeyframeAnimation> animations;
-    KeyframeAnimation* currentAnimation;
-    KeyframeAnimation* targetAnimation;    // For blending
-    PlayMode currentMode;
-    AnimationState currentState;
-    float globalSpeed;
+    struct Channel {
+        NotifierBase* notifier;
+        ChannelKind kind;
+        int activeIndex;   // Position in its active list, -1 while idle
+    };
     
-    // Timing and state tracking
-    unsigned long startTime;
-    unsigned long pauseTime;
-    unsigned long totalPausedTime;
-    int currentKeyframeIndex;
-    int nextKeyframeIndex;
-    float currentValue;
-    bool isReversing;
-    bool isPlayingBackward;
+    std::vector<Channel> channels;           // Every registered notifier
+    std::vector<ServoNotifier*> activeServos; // Dense lists visited by update()
+    std::vector<LEDNotifier*> activeLEDs;
+    std::vector<SinkNotifier*> activeSinkChannels;
+    std::vector<RGBNotifier*> activeRGBs;
+    std::vector<OutputSink*> sinks;          // Flushed at the end of update()
+    Timeline* timeline;                      // Fires its cues at the start of update()
+    TimeSource timeSource;                   // now == nullptr: use the default clock
     
-    // Value adjustment properties
-    float valueScale;     // Multiplier for final value
-    float valueOffset;    // Added to final value
-    float minValue;       // Output clamping minimum
-    float maxValue;       // Output clamping maximum
+    bool join(NotifierBase& notifier, ChannelKind kind);
+    void leave(int slot);
+    void activate(int slot);
+    template <typename Notifier>
+    void dropActive(std::vector<Notifier*>& list, int index);
+    template <typename Notifier>
+    void updateActive(std::vector<Notifier*>& list, unsigned long now);
     
-    // Blend control
-    bool isBlending;
-    unsigned long blendStartTime;
-    unsigned long blendDuration;
-    float startValue;     // Value at blend start
+    friend class NotifierBase;
+
+public:
+    NotifierGroup();
+    ~NotifierGroup();
     
-    // Internal methods
-    float interpolateValue(float startVal, float endVal, float t);
-    float calculateCurrentValue();
+    // Members point back at their group, so it cannot be copied
+    NotifierGroup(const NotifierGroup&) = delete;
+    NotifierGroup& operator=(const NotifierGroup&) = delete;
     
-public:
-    LEDNotifier(int pin, LEDMode mode = ANALOG);
-    void begin();
+    // Register notifiers by reference (each can belong to one group).
+    // A notifier leaves its group when destroyed; copies are not members
+    bool add(ServoNotifier& notifier);
+    bool add(LEDNotifier& notifier);
+    bool add(SinkNotifier& notifier);
+    bool add(RGBNotifier& notifier);
     
-    // Animation management
-    void addAnimation(const KeyframeAnimation& animation);
+    // Clock for the whole group; also given to every member
+    void setTimeSource(const TimeSource& source);
     
-    // Play animation by reference
-    void playAnimation(const KeyframeAnimation& animation, PlayMode mode = PLAY_ONCE);
+    // Fire this timeline's cues in update(), on the group's clock, and
+    // count them in timeToNextChange(). nullptr detaches it
+    void setTimeline(Timeline* cues);
     
-    // Play animation by name
-    bool playAnimation(const String& name, PlayMode mode = PLAY_ONCE);
+    // Fire any timeline cues, update every playing notifier, then flush
+    // the output sinks
+    void update();
+    void update(unsigned long now);
     
-    // Enhanced transition methods
-    void crossfadeTo(const KeyframeAnimation& animation, unsigned long blendTime, PlayMode mode = PLAY_ONCE);
-    bool crossfadeTo(const String& name, unsigned long blendTime, PlayMode mode = PLAY_ONCE);
+    // Clock ticks until any member's getValue() changes (see
+    // NotifierBase::timeToNextChange()). Call right after update()
+    unsigned long timeToNextChange() const;
+    unsigned long timeToNextChange(unsigned long now) const;
     
-    // Set mode after construction
-    void setMode(LEDMode newMode);
+    // Status methods
+    int getCount() const;        // Registered notifiers
+    int getActiveCount() const;  // Notifiers visited by update()
+};
+
+// ----------------------------------------------------------------
+// Timeline Class
+// A cue sheet: animations to play or crossfade to at set times from
+// start(). Cues are kept in time order and update() only looks at the
+// next one, so thousands cost no more per frame than a few. A late
+// frame fires every cue it passed, in order, each playing as if it had
+// fired on time
+// ----------------------------------------------------------------
+class Timeline {
+private:
+    struct Cue {
+        unsigned long time;        // ms from start()
+        NotifierBase* notifier;
+        AnimationId animation;
+        PlayMode mode;
+        unsigned long blendTime;   // 0: play; otherwise crossfade over this many ms
+    };
     
-    // Set threshold for digital mode
-    void setThreshold(float newThreshold);
+    std::vector<Cue> cues;     // By time; equal times in the order added
+    int nextCue;               // Cursor: the first cue not yet fired
+    unsigned long baseMs;      // ms from start() at baseTick
+    unsigned long baseTick;    // Moves on in whole ms, so a show can outlast the clock's wrap
+    bool running;
+    TimeSource timeSource;     // now == nullptr: use the default clock
     
-    // Value adjustment methods
-    void setValueScale(float scale);
-    void setValueOffset(float offset);
-    void setValueRange(float min, float max);
+    const TimeSource& clock() const;
+    void fire(const Cue& cue, unsigned long late);
+
+public:
+    Timeline();
     
-    // Playback control
-    void pause();
-    void resume();
-    void stop();
+    // Room for this many cues, so adding them never reallocates
+    void reserve(int cueCount);
     
-    // Update and apply value to LED directly
-    void update();
+    // Play (blendTime 0) or crossfade to an animation on a notifier at
+    // time ms from start(). Cues may be added in any order; in time
+    // order each costs O(1). A cue added behind a running timeline's
+    // position waits for the next start(). Returns false for an unknown
+    // animation or one the notifier cannot play
+    bool addCue(unsigned long time, NotifierBase& notifier, AnimationId animation,
+                PlayMode mode = PLAY_ONCE, unsigned long blendTime = 0);
+    bool addCue(unsigned long time, NotifierBase& notifier, const String& name,
+                PlayMode mode = PLAY_ONCE, unsigned long blendTime = 0);
+    void clear();
     
-    // Get the current interpolated and adjusted value as an integer
-    int getValue() const;
+    // Clock for the cue times (defaults to getDefaultTimeSource())
+    void setTimeSource(const TimeSource& source);
     
-    // Check if the value has changed since last getValue() call
-    bool hasChanged();
+    // Run from the first cue. A start in the past fires everything due
+    // at the next update(), so the show joins where it should be
+    void start();
+    void start(unsigned long now);
+    void stop();
     
-    // Speed control
-    void setGlobalSpeed(float speed);
-    float getGlobalSpeed() const;
+    // Fire every cue that is due, in order. Call before updating the
+    // notifiers, or let a NotifierGroup do it. Returns the cues fired
+    int update();
+    int update(unsigned long now);
     
-    // Status methods
-    String getCurrentAnimationName() const;
-    bool isPlaying() const;
-    bool isPaused() const;
-    bool isCompleted() const;
-    bool completed() const;  // Alias for isCompleted
-    bool isBlendingAnimations() const;
-    AnimationState getState() const;
+    // Clock ticks until the next cue; 0 if one is due, NO_CHANGE if
+    // none is left or the timeline is stopped
+    unsigned long timeToNextCue() const;
+    unsigned long timeToNextCue(unsigned long now) const;
     
-    // Timing methods
-    unsigned long timeToNextKey() const;
-    unsigned long timeRemaining() const;
+    // Status methods
+    bool isRunning() const;
+    bool isFinished() const;     // Running, with every cue fired
+    int getCueCount() const;
+    int getNextCue() const;      // Index of the next cue to fire
+    unsigned long getCueTime(int index) const;
 };
 
 // ----------------------------------------------------------------
@@ -285,14 +1075,7 @@ public:
 // ----------------------------------------------------------------
 class RGBKeyframeAnimation {
 private:
-    String name;
-    struct RGBKeyframe {
-        byte red;
-        byte green;
-        byte blue;
-        unsigned long time;
-    };
-    std::vector<RGBKeyframe> keyframes;
+    KeyframeAnimation animation;   // Colour keyframes, played by RGBNotifier
 
 public:
     RGBKeyframeAnimation(const String& name = "");
@@ -309,6 +1092,59 @@ public:
     const String& getName() const;
     void getKeyFrameColor(int index, byte& r, byte& g, byte& b) const;
     unsigned long getKeyFrameTime(int index) const;
+    
+    // The keyframes in the form notifiers play
+    const KeyframeAnimation& getAnimation() const;
+};
+
+// ----------------------------------------------------------------
+// RGBNotifier Class
+// Plays RGBKeyframeAnimations on an RGB LED, or computes the colour
+// for the sketch to use. Modes, crossfades and speed work as on the
+// other notifiers
+// ----------------------------------------------------------------
+class RGBNotifier : public NotifierBase {
+private:
+    int redPin;       // -1: no pins, read the colour with getColor()
+    int greenPin;
+    int bluePin;
+    uint32_t color;   // Packed 0xRRGGBB
+    
+    uint32_t calculateColor() const;
+
+public:
+    RGBNotifier();
+    RGBNotifier(int redPin, int greenPin, int bluePin);
+    void begin();
+    
+    // Animation management (returns the animation's ID)
+    AnimationId addAnimation(const RGBKeyframeAnimation& animation);
+    
+    // Play and crossfade colour animations; by name and ID as on the
+    // other notifiers
+    void playAnimation(const RGBKeyframeAnimation& animation, PlayMode mode = PLAY_ONCE);
+    void crossfadeTo(const RGBKeyframeAnimation& animation, unsigned long blendTime, PlayMode mode = PLAY_ONCE);
+    bool playAt(const RGBKeyframeAnimation& animation, const WallClock& clock, unsigned long epochSeconds,
+                PlayMode mode = PLAY_ONCE);
+    using NotifierBase::playAnimation;
+    using NotifierBase::crossfadeTo;
+    using NotifierBase::playAt;
+    
+    // Plain animations have no colours to play
+    void playAnimation(const KeyframeAnimation& animation, PlayMode mode = PLAY_ONCE) = delete;
+    void crossfadeTo(const KeyframeAnimation& animation, unsigned long blendTime, PlayMode mode = PLAY_ONCE) = delete;
+    bool playAt(const KeyframeAnimation& animation, const WallClock& clock, unsigned long epochSeconds,
+                PlayMode mode = PLAY_ONCE) = delete;
+    
+    // Update the colour and write it to the pins, if any
+    void update();
+    void update(unsigned long now);   // Use a timestamp already read from the clock
+    
+    // Current colour
+    uint32_t getColor() const;   // Packed 0xRRGGBB
+    byte getRed() const;
+    byte getGreen() const;
+    byte getBlue() const;
 };
 
 #endif // YOUVEBEENNOTIFIED_H
\ No newline at end of file